@@ -2,10 +2,13 @@
 #include "Shape.h"
 
 #include <cstdlib>
+#include <algorithm>
 #include "arithmetics.hpp"
 #include "convergent-curve-ordering.h"
 
 #define DECONVERGE_OVERSHOOT 1.11111111111111111 // moves control points slightly more than necessary to account for floating-point errors
+// Maximum number of subdivision steps when proving that a pair of edges doesn't intersect
+#define OVERLAP_CHECK_MAX_DEPTH 32
 
 namespace msdfgen {
 
@@ -141,44 +144,174 @@ int Shape::edgeCount() const {
     return total;
 }
 
-void Shape::orientContours() {
-    struct Intersection {
-        double x;
-        int direction;
+/// Static interval tree of the vertical extents of a shape's edges, which finds all edges possibly intersected by a horizontal scanline.
+class EdgeIntervalTree {
+
+public:
+    struct Interval {
+        double yMin, yMax;
+        const EdgeSegment *edge;
         int contourIndex;
+    };
+
+    explicit EdgeIntervalTree(const std::vector<Contour> &contours) {
+        for (int i = 0; i < (int) contours.size(); ++i) {
+            for (std::vector<EdgeHolder>::const_iterator edge = contours[i].edges.begin(); edge != contours[i].edges.end(); ++edge) {
+                // The range of the control points encloses the edge regardless of numerical precision of its exact bounds
+                const Point2 *p = (*edge)->controlPoints();
+                Interval interval = { p[0].y, p[0].y, &**edge, i };
+                for (int j = 1; j <= (*edge)->type(); ++j) {
+                    interval.yMin = min(interval.yMin, p[j].y);
+                    interval.yMax = max(interval.yMax, p[j].y);
+                }
+                intervals.push_back(interval);
+            }
+        }
+        std::vector<int> items(intervals.size());
+        for (int i = 0; i < (int) items.size(); ++i)
+            items[i] = i;
+        root = items.empty() ? -1 : buildNode(items);
+    }
 
-        static int compare(const void *a, const void *b) {
-            return sign(reinterpret_cast<const Intersection *>(a)->x-reinterpret_cast<const Intersection *>(b)->x);
+    /// Appends intervals that contain y to output.
+    void query(std::vector<const Interval *> &output, double y) const {
+        for (int nodeIndex = root; nodeIndex >= 0;) {
+            const Node &node = nodes[nodeIndex];
+            if (y < node.center) {
+                for (int i = node.start; i < node.end && intervals[byMin[i]].yMin <= y; ++i)
+                    output.push_back(&intervals[byMin[i]]);
+                nodeIndex = node.left;
+            } else if (y > node.center) {
+                for (int i = node.start; i < node.end && intervals[byMax[i]].yMax >= y; ++i)
+                    output.push_back(&intervals[byMax[i]]);
+                nodeIndex = node.right;
+            } else {
+                for (int i = node.start; i < node.end; ++i)
+                    output.push_back(&intervals[byMin[i]]);
+                break;
+            }
         }
+    }
+
+private:
+    struct Node {
+        double center;
+        // Range of intervals that contain center in byMin and byMax
+        int start, end;
+        int left, right;
     };
 
+    struct IntervalMidpointLess {
+        const std::vector<Interval> *intervals;
+        bool operator()(int a, int b) const {
+            return (*intervals)[a].yMin+(*intervals)[a].yMax < (*intervals)[b].yMin+(*intervals)[b].yMax;
+        }
+    };
+    struct IntervalMinLess {
+        const std::vector<Interval> *intervals;
+        bool operator()(int a, int b) const {
+            return (*intervals)[a].yMin < (*intervals)[b].yMin;
+        }
+    };
+    struct IntervalMaxGreater {
+        const std::vector<Interval> *intervals;
+        bool operator()(int a, int b) const {
+            return (*intervals)[a].yMax > (*intervals)[b].yMax;
+        }
+    };
+
+    std::vector<Interval> intervals;
+    std::vector<Node> nodes;
+    std::vector<int> byMin, byMax;
+    int root;
+
+    int buildNode(std::vector<int> &items) {
+        // The median midpoint as center guarantees that each subtree has at most half of the intervals
+        IntervalMidpointLess midpointLess = { &intervals };
+        std::nth_element(items.begin(), items.begin()+items.size()/2, items.end(), midpointLess);
+        const Interval &median = intervals[items[items.size()/2]];
+        double center = .5*(median.yMin+median.yMax);
+        std::vector<int> leftItems, rightItems;
+        Node node;
+        node.center = center;
+        node.start = (int) byMin.size();
+        for (std::vector<int>::const_iterator item = items.begin(); item != items.end(); ++item) {
+            if (intervals[*item].yMax < center)
+                leftItems.push_back(*item);
+            else if (intervals[*item].yMin > center)
+                rightItems.push_back(*item);
+            else {
+                byMin.push_back(*item);
+                byMax.push_back(*item);
+            }
+        }
+        node.end = (int) byMin.size();
+        IntervalMinLess minLess = { &intervals };
+        IntervalMaxGreater maxGreater = { &intervals };
+        std::sort(byMin.begin()+node.start, byMin.end(), minLess);
+        std::sort(byMax.begin()+node.start, byMax.end(), maxGreater);
+        std::vector<int>().swap(items);
+        int nodeIndex = (int) nodes.size();
+        nodes.push_back(node);
+        int left = leftItems.empty() ? -1 : buildNode(leftItems);
+        int right = rightItems.empty() ? -1 : buildNode(rightItems);
+        nodes[nodeIndex].left = left;
+        nodes[nodeIndex].right = right;
+        return nodeIndex;
+    }
+
+};
+
+struct ScanlineIntersection {
+    double x;
+    int direction;
+    int contourIndex;
+
+    static int compare(const void *a, const void *b) {
+        return sign(reinterpret_cast<const ScanlineIntersection *>(a)->x-reinterpret_cast<const ScanlineIntersection *>(b)->x);
+    }
+};
+
+/// Finds an Y that crosses the contour.
+static double contourCrossingY(const Contour &contour) {
     const double ratio = .5*(sqrt(5)-1); // an irrational number to minimize chance of intersecting a corner or other point of interest
+    double y0 = contour.edges.front()->point(0).y;
+    double y1 = y0;
+    for (std::vector<EdgeHolder>::const_iterator edge = contour.edges.begin(); edge != contour.edges.end() && y0 == y1; ++edge)
+        y1 = (*edge)->point(1).y;
+    for (std::vector<EdgeHolder>::const_iterator edge = contour.edges.begin(); edge != contour.edges.end() && y0 == y1; ++edge)
+        y1 = (*edge)->point(ratio).y; // in case all endpoints are in a horizontal line
+    return mix(y0, y1, ratio);
+}
+
+/// Outputs the intersections of the scanline at y with the edges of edgeTree sorted by X coordinate.
+static void sortedScanlineIntersections(std::vector<ScanlineIntersection> &intersections, std::vector<const EdgeIntervalTree::Interval *> &crossedEdges, const EdgeIntervalTree &edgeTree, double y) {
+    // Scanline through whole shape at Y, only edges whose vertical extent contains Y can be intersected
+    double x[3];
+    int dy[3];
+    intersections.clear();
+    crossedEdges.clear();
+    edgeTree.query(crossedEdges, y);
+    for (std::vector<const EdgeIntervalTree::Interval *>::const_iterator edge = crossedEdges.begin(); edge != crossedEdges.end(); ++edge) {
+        int n = (*edge)->edge->scanlineIntersections(x, dy, y);
+        for (int k = 0; k < n; ++k) {
+            ScanlineIntersection intersection = { x[k], dy[k], (*edge)->contourIndex };
+            intersections.push_back(intersection);
+        }
+    }
+    if (!intersections.empty())
+        qsort(&intersections[0], intersections.size(), sizeof(ScanlineIntersection), &ScanlineIntersection::compare);
+}
+
+void Shape::orientContours() {
     std::vector<int> orientations(contours.size());
-    std::vector<Intersection> intersections;
+    std::vector<ScanlineIntersection> intersections;
+    std::vector<const EdgeIntervalTree::Interval *> crossedEdges;
+    EdgeIntervalTree edgeTree(contours);
     for (int i = 0; i < (int) contours.size(); ++i) {
         if (!orientations[i] && !contours[i].edges.empty()) {
-            // Find an Y that crosses the contour
-            double y0 = contours[i].edges.front()->point(0).y;
-            double y1 = y0;
-            for (std::vector<EdgeHolder>::const_iterator edge = contours[i].edges.begin(); edge != contours[i].edges.end() && y0 == y1; ++edge)
-                y1 = (*edge)->point(1).y;
-            for (std::vector<EdgeHolder>::const_iterator edge = contours[i].edges.begin(); edge != contours[i].edges.end() && y0 == y1; ++edge)
-                y1 = (*edge)->point(ratio).y; // in case all endpoints are in a horizontal line
-            double y = mix(y0, y1, ratio);
-            // Scanline through whole shape at Y
-            double x[3];
-            int dy[3];
-            for (int j = 0; j < (int) contours.size(); ++j) {
-                for (std::vector<EdgeHolder>::const_iterator edge = contours[j].edges.begin(); edge != contours[j].edges.end(); ++edge) {
-                    int n = (*edge)->scanlineIntersections(x, dy, y);
-                    for (int k = 0; k < n; ++k) {
-                        Intersection intersection = { x[k], dy[k], j };
-                        intersections.push_back(intersection);
-                    }
-                }
-            }
+            sortedScanlineIntersections(intersections, crossedEdges, edgeTree, contourCrossingY(contours[i]));
             if (!intersections.empty()) {
-                qsort(&intersections[0], intersections.size(), sizeof(Intersection), &Intersection::compare);
                 // Disqualify multiple intersections
                 for (int j = 1; j < (int) intersections.size(); ++j)
                     if (intersections[j].x == intersections[j-1].x)
@@ -187,7 +320,6 @@ void Shape::orientContours() {
                 for (int j = 0; j < (int) intersections.size(); ++j)
                     if (intersections[j].direction)
                         orientations[intersections[j].contourIndex] += 2*((j&1)^(intersections[j].direction > 0))-1;
-                intersections.clear();
             }
         }
     }
@@ -197,6 +329,177 @@ void Shape::orientContours() {
             contours[i].reverse();
 }
 
+/// A Bezier curve of a given degree, which may be a portion of an edge segment.
+struct BezierPiece {
+    Point2 p[4];
+    int degree;
+
+    void bound(double &xMin, double &yMin, double &xMax, double &yMax) const {
+        xMin = xMax = p[0].x, yMin = yMax = p[0].y;
+        for (int i = 1; i <= degree; ++i) {
+            xMin = min(xMin, p[i].x), yMin = min(yMin, p[i].y);
+            xMax = max(xMax, p[i].x), yMax = max(yMax, p[i].y);
+        }
+    }
+
+    void split(BezierPiece &a, BezierPiece &b) const {
+        Point2 q[4] = { p[0], p[1], p[2], p[3] };
+        a.degree = b.degree = degree;
+        a.p[0] = q[0], b.p[degree] = q[degree];
+        for (int level = 1; level <= degree; ++level) {
+            for (int i = 0; i <= degree-level; ++i)
+                q[i] = mix(q[i], q[i+1], .5);
+            a.p[level] = q[0], b.p[degree-level] = q[degree-level];
+        }
+    }
+};
+
+static BezierPiece edgePiece(const EdgeSegment *edge) {
+    BezierPiece piece;
+    piece.degree = edge->type();
+    for (int i = 0; i <= piece.degree; ++i)
+        piece.p[i] = edge->controlPoints()[i];
+    return piece;
+}
+
+/// Returns false if the two curves provably don't intersect, which is determined by recursive subdivision until their control point bounds are disjoint.
+static bool curvesMayIntersect(const BezierPiece &a, const BezierPiece &b, int depth) {
+    double aXMin, aYMin, aXMax, aYMax, bXMin, bYMin, bXMax, bYMax;
+    a.bound(aXMin, aYMin, aXMax, aYMax);
+    b.bound(bXMin, bYMin, bXMax, bYMax);
+    if (aXMax < bXMin || bXMax < aXMin || aYMax < bYMin || bYMax < aYMin)
+        return false;
+    if (depth >= OVERLAP_CHECK_MAX_DEPTH)
+        return true;
+    BezierPiece parts[2];
+    if (max(aXMax-aXMin, aYMax-aYMin) >= max(bXMax-bXMin, bYMax-bYMin)) {
+        a.split(parts[0], parts[1]);
+        return curvesMayIntersect(parts[0], b, depth+1) || curvesMayIntersect(parts[1], b, depth+1);
+    } else {
+        b.split(parts[0], parts[1]);
+        return curvesMayIntersect(a, parts[0], depth+1) || curvesMayIntersect(a, parts[1], depth+1);
+    }
+}
+
+/// Computes the range of angles of the control points as seen from the apex, returns false if the range is not narrower than a half-turn.
+static bool controlPointAngles(double &from, double &span, const Point2 *p, int count, Point2 apex) {
+    bool first = true;
+    double lo = 0, hi = 0;
+    for (int i = 0; i < count; ++i) {
+        Vector2 v = p[i]-apex;
+        if (!v)
+            continue;
+        double angle = atan2(v.y, v.x);
+        if (first) {
+            from = angle;
+            first = false;
+        } else {
+            double relative = angle-from;
+            if (relative > M_PI)
+                relative -= 2*M_PI;
+            else if (relative <= -M_PI)
+                relative += 2*M_PI;
+            lo = min(lo, relative);
+            hi = max(hi, relative);
+        }
+    }
+    from += lo;
+    span = hi-lo;
+    return !first && span < M_PI;
+}
+
+/// Returns false if the curves provably intersect only at their common point, which is the end point of a and the start point of b.
+static bool adjacentCurvesMayIntersect(const BezierPiece &a, const BezierPiece &b, int depth) {
+    // If all control points of a and b lie in disjoint angular sectors around the common point, so do the curves
+    Point2 apex = b.p[0];
+    double aFrom, aSpan, bFrom, bSpan;
+    if (controlPointAngles(aFrom, aSpan, a.p, a.degree, apex) && controlPointAngles(bFrom, bSpan, b.p+1, b.degree, apex)) {
+        double offset = fmod(bFrom-aFrom, 2*M_PI);
+        if (offset < 0)
+            offset += 2*M_PI;
+        if (offset > aSpan && offset+bSpan < 2*M_PI)
+            return false;
+    }
+    if (depth >= OVERLAP_CHECK_MAX_DEPTH)
+        return true;
+    BezierPiece aParts[2], bParts[2];
+    a.split(aParts[0], aParts[1]);
+    b.split(bParts[0], bParts[1]);
+    return curvesMayIntersect(aParts[0], b, depth+1) || curvesMayIntersect(aParts[1], bParts[1], depth+1) || adjacentCurvesMayIntersect(aParts[1], bParts[0], depth+1);
+}
+
+struct EdgeBounds {
+    double xMin, yMin, xMax, yMax;
+    int contourIndex, edgeIndex;
+
+    static int compare(const void *a, const void *b) {
+        return sign(reinterpret_cast<const EdgeBounds *>(a)->xMin-reinterpret_cast<const EdgeBounds *>(b)->xMin);
+    }
+};
+
+bool Shape::isOverlapFree() const {
+    // No edges may intersect, except consecutive edges at their common point
+    std::vector<EdgeBounds> edgeBounds;
+    for (int i = 0; i < (int) contours.size(); ++i) {
+        if (contours[i].edges.empty())
+            continue;
+        if (contours[i].edges.size() < 3)
+            return false;
+        for (int j = 0; j < (int) contours[i].edges.size(); ++j) {
+            EdgeBounds bounds;
+            edgePiece(contours[i].edges[j]).bound(bounds.xMin, bounds.yMin, bounds.xMax, bounds.yMax);
+            bounds.contourIndex = i, bounds.edgeIndex = j;
+            edgeBounds.push_back(bounds);
+        }
+    }
+    if (edgeBounds.empty())
+        return true;
+    qsort(&edgeBounds[0], edgeBounds.size(), sizeof(EdgeBounds), &EdgeBounds::compare);
+    for (int i = 0; i < (int) edgeBounds.size(); ++i) {
+        const EdgeBounds &a = edgeBounds[i];
+        for (int j = i+1; j < (int) edgeBounds.size() && edgeBounds[j].xMin <= a.xMax; ++j) {
+            const EdgeBounds &b = edgeBounds[j];
+            if (b.yMax < a.yMin || a.yMax < b.yMin)
+                continue;
+            BezierPiece aPiece = edgePiece(contours[a.contourIndex].edges[a.edgeIndex]);
+            BezierPiece bPiece = edgePiece(contours[b.contourIndex].edges[b.edgeIndex]);
+            bool mayIntersect = true;
+            if (a.contourIndex == b.contourIndex) {
+                int edgeCount = (int) contours[a.contourIndex].edges.size();
+                if ((a.edgeIndex+1)%edgeCount == b.edgeIndex)
+                    mayIntersect = adjacentCurvesMayIntersect(aPiece, bPiece, 0);
+                else if ((b.edgeIndex+1)%edgeCount == a.edgeIndex)
+                    mayIntersect = adjacentCurvesMayIntersect(bPiece, aPiece, 0);
+                else
+                    mayIntersect = curvesMayIntersect(aPiece, bPiece, 0);
+            } else
+                mayIntersect = curvesMayIntersect(aPiece, bPiece, 0);
+            if (mayIntersect)
+                return false;
+        }
+    }
+    // Without intersections, the winding on either side of each contour is the same along its whole length, so one scanline per contour suffices to check that it stays between 0 and 1
+    std::vector<bool> checked(contours.size());
+    std::vector<ScanlineIntersection> intersections;
+    std::vector<const EdgeIntervalTree::Interval *> crossedEdges;
+    EdgeIntervalTree edgeTree(contours);
+    for (int i = 0; i < (int) contours.size(); ++i) {
+        if (!checked[i] && !contours[i].edges.empty()) {
+            sortedScanlineIntersections(intersections, crossedEdges, edgeTree, contourCrossingY(contours[i]));
+            int winding = 0;
+            for (std::vector<ScanlineIntersection>::const_iterator intersection = intersections.begin(); intersection != intersections.end(); ++intersection) {
+                winding += intersection->direction;
+                if (!(winding == 0 || winding == 1))
+                    return false;
+                checked[intersection->contourIndex] = true;
+            }
+            if (!checked[i])
+                return false;
+        }
+    }
+    return true;
+}
+
 YAxisOrientation Shape::getYAxisOrientation() const {
     return inverseYAxis ? MSDFGEN_Y_AXIS_NONDEFAULT_ORIENTATION : MSDFGEN_Y_AXIS_DEFAULT_ORIENTATION;
 }
@@ -50,6 +50,8 @@ public:
     int edgeCount() const;
     /// Assumes its contours are unoriented (even-odd fill rule). Attempts to orient them to conform to the non-zero winding rule.
     void orientContours();
+    /// Returns true if it can be proven that the contours don't intersect and that the winding number is 0 or 1 everywhere, in which case support for overlapping contours isn't needed.
+    bool isOverlapFree() const;
     /// Returns the orientation of the axis of the shape's Y coordinates.
     YAxisOrientation getYAxisOrientation() const;
     /// Sets the orientation of the axis of the shape's Y coordinates.
@@ -5,6 +5,7 @@
 #include "Vector2.hpp"
 #include "edge-selectors.h"
 #include "contour-combiners.h"
+#include "ShapeDistanceQuery.h"
 
 namespace msdfgen {
 
@@ -17,16 +18,15 @@ public:
 
     // Passed shape object must persist until the distance finder is destroyed!
     explicit ShapeDistanceFinder(const Shape &shape);
-    /// Finds the distance from origin. Not thread-safe! Is fastest when subsequent queries are close together.
+    /// Finds the distance from origin. Not thread-safe! Use ShapeDistanceQuery for concurrent queries. Is fastest when subsequent queries are close together.
     DistanceType distance(const Point2 &origin);
 
     /// Finds the distance between shape and origin. Does not allocate result cache used to optimize performance of multiple queries.
     static DistanceType oneShotDistance(const Shape &shape, const Point2 &origin);
 
 private:
-    const Shape &shape;
-    ContourCombiner contourCombiner;
-    std::vector<typename ContourCombiner::EdgeSelectorType::EdgeCache> shapeEdgeCache;
+    ShapeDistanceQuery<ContourCombiner> query;
+    typename ShapeDistanceQuery<ContourCombiner>::Workspace workspace;
 
 };
 
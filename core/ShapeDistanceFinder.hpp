@@ -4,33 +4,11 @@
 namespace msdfgen {
 
 template <class ContourCombiner>
-ShapeDistanceFinder<ContourCombiner>::ShapeDistanceFinder(const Shape &shape) : shape(shape), contourCombiner(shape), shapeEdgeCache(shape.edgeCount()) { }
+ShapeDistanceFinder<ContourCombiner>::ShapeDistanceFinder(const Shape &shape) : query(shape), workspace(query) { }
 
 template <class ContourCombiner>
 typename ShapeDistanceFinder<ContourCombiner>::DistanceType ShapeDistanceFinder<ContourCombiner>::distance(const Point2 &origin) {
-    contourCombiner.reset(origin);
-#ifdef MSDFGEN_USE_CPP11
-    typename ContourCombiner::EdgeSelectorType::EdgeCache *edgeCache = shapeEdgeCache.data();
-#else
-    typename ContourCombiner::EdgeSelectorType::EdgeCache *edgeCache = shapeEdgeCache.empty() ? NULL : &shapeEdgeCache[0];
-#endif
-
-    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
-        if (!contour->edges.empty()) {
-            typename ContourCombiner::EdgeSelectorType &edgeSelector = contourCombiner.edgeSelector(int(contour-shape.contours.begin()));
-
-            const EdgeSegment *prevEdge = contour->edges.size() >= 2 ? *(contour->edges.end()-2) : *contour->edges.begin();
-            const EdgeSegment *curEdge = contour->edges.back();
-            for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
-                const EdgeSegment *nextEdge = *edge;
-                edgeSelector.addEdge(*edgeCache++, prevEdge, curEdge, nextEdge);
-                prevEdge = curEdge;
-                curEdge = nextEdge;
-            }
-        }
-    }
-
-    return contourCombiner.distance();
+    return query.distance(workspace, origin);
 }
 
 template <class ContourCombiner>
@@ -39,7 +17,8 @@ typename ShapeDistanceFinder<ContourCombiner>::DistanceType ShapeDistanceFinder<
     contourCombiner.reset(origin);
 
     for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
-        if (!contour->edges.empty()) {
+        // A fresh contour combiner has no distance bound, so every contour is relevant
+        if (!contour->edges.empty() && contourCombiner.isContourRelevant(int(contour-shape.contours.begin()))) {
             typename ContourCombiner::EdgeSelectorType &edgeSelector = contourCombiner.edgeSelector(int(contour-shape.contours.begin()));
 
             const EdgeSegment *prevEdge = contour->edges.size() >= 2 ? *(contour->edges.end()-2) : *contour->edges.begin();
@@ -0,0 +1,74 @@
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include "Vector2.hpp"
+#include "edge-selectors.h"
+#include "contour-combiners.h"
+
+namespace msdfgen {
+
+/// Finds the distances between points and a Shape, possibly from multiple threads at once. ContourCombiner dictates the distance metric and its data type,
+/// e.g. SimpleContourCombiner<NearestEdgeSelector> also identifies the nearest edge and its nearest point. The query itself is immutable after construction
+/// and each thread keeps the mutable state of its queries in its own Workspace. Results match oneShotDistance of ShapeDistanceFinder regardless of the order
+/// of the queries or their workspace, except in rare cases where an edge's cached distance is overestimated by the approximate closest point search of cubic segments.
+template <class ContourCombiner>
+class ShapeDistanceQuery {
+
+public:
+    typedef typename ContourCombiner::DistanceType DistanceType;
+
+    /// Per-thread state of the queries, which may only be used by one thread at a time, but by any number of queries of the same shape.
+    class Workspace {
+        friend class ShapeDistanceQuery<ContourCombiner>;
+
+    public:
+        explicit Workspace(const ShapeDistanceQuery<ContourCombiner> &query);
+
+    private:
+        ContourCombiner contourCombiner;
+        /// Results of the last evaluation of each edge, parallel to the query's edges.
+        std::vector<typename ContourCombiner::EdgeSelectorType::EdgeCache> edgeCache;
+        /// Order in which the origins of a batch are evaluated, as pairs of their keys along the Z-order curve and indices.
+        std::vector<std::pair<unsigned, int> > batchOrder;
+
+    };
+
+    // Passed shape object must persist until the query and its workspaces are destroyed!
+    explicit ShapeDistanceQuery(const Shape &shape);
+    /// Finds the distance from origin. Is fastest when subsequent queries with the same workspace are close together.
+    DistanceType distance(Workspace &workspace, const Point2 &origin) const;
+    /// Finds the distances from count origins and stores them in distances. The origins are evaluated in the order of a space-filling curve,
+    /// so that most edges can be skipped thanks to the previous evaluation even if they are scattered.
+    void distances(Workspace &workspace, DistanceType *distances, const Point2 *origins, int count) const;
+    /// Finds the distances from count origins and stores them in distances with a temporary workspace, which is only worth it for large batches.
+    void distances(DistanceType *distances, const Point2 *origins, int count) const;
+
+private:
+    /// An edge together with its neighbors in the contour and its type.
+    struct EdgeNeighborhood {
+        const EdgeSegment *prevEdge, *edge, *nextEdge;
+        int type;
+    };
+
+    const Shape &shape;
+    /// Edges of all contours in their original order, which is also the order of evaluation, since edge selectors resolve exact ties in favor of the first edge.
+    std::vector<EdgeNeighborhood> edges;
+    /// Edges of contour i occupy edges from contourEdgeBounds[i] to contourEdgeBounds[i+1].
+    std::vector<int> contourEdgeBounds;
+
+    /// Spreads the lower 16 bits of x to the even bits of the result.
+    static unsigned spreadBits(unsigned x);
+    /// Passes the edges of contours which the workspace's contour combiner deems relevant to their edge selectors, returns false if there are none.
+    bool addRelevantContours(Workspace &workspace) const;
+    /// Passes edges of edges in range [begin, end) to the edge selector as their known types, which avoids virtual dispatch.
+    void addEdges(Workspace &workspace, typename ContourCombiner::EdgeSelectorType &edgeSelector, int begin, int end) const;
+
+};
+
+typedef ShapeDistanceQuery<SimpleContourCombiner<TrueDistanceSelector> > SimpleTrueShapeDistanceQuery;
+
+}
+
+#include "ShapeDistanceQuery.hpp"
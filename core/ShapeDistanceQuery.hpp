@@ -0,0 +1,112 @@
+
+#include "ShapeDistanceQuery.h"
+
+#include <algorithm>
+#include "arithmetics.hpp"
+
+namespace msdfgen {
+
+template <class ContourCombiner>
+ShapeDistanceQuery<ContourCombiner>::Workspace::Workspace(const ShapeDistanceQuery<ContourCombiner> &query) : contourCombiner(query.shape), edgeCache(query.edges.size()) { }
+
+template <class ContourCombiner>
+ShapeDistanceQuery<ContourCombiner>::ShapeDistanceQuery(const Shape &shape) : shape(shape) {
+    edges.reserve(shape.edgeCount());
+    contourEdgeBounds.reserve(shape.contours.size()+1);
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
+        contourEdgeBounds.push_back(int(edges.size()));
+        if (!contour->edges.empty()) {
+            EdgeNeighborhood neighborhood;
+            neighborhood.prevEdge = contour->edges.size() >= 2 ? *(contour->edges.end()-2) : *contour->edges.begin();
+            neighborhood.edge = contour->edges.back();
+            for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+                neighborhood.nextEdge = *edge;
+                neighborhood.type = neighborhood.edge->type();
+                edges.push_back(neighborhood);
+                neighborhood.prevEdge = neighborhood.edge;
+                neighborhood.edge = neighborhood.nextEdge;
+            }
+        }
+    }
+    contourEdgeBounds.push_back(int(edges.size()));
+}
+
+template <class ContourCombiner>
+typename ShapeDistanceQuery<ContourCombiner>::DistanceType ShapeDistanceQuery<ContourCombiner>::distance(Workspace &workspace, const Point2 &origin) const {
+    workspace.contourCombiner.reset(origin);
+    addRelevantContours(workspace);
+    DistanceType distance = workspace.contourCombiner.distance();
+    // The result may reveal that more distant contours can affect it
+    while (addRelevantContours(workspace))
+        distance = workspace.contourCombiner.distance();
+    return distance;
+}
+
+template <class ContourCombiner>
+void ShapeDistanceQuery<ContourCombiner>::distances(Workspace &workspace, DistanceType *distances, const Point2 *origins, int count) const {
+    if (count <= 0)
+        return;
+    Point2 lower = origins[0], upper = origins[0];
+    for (int i = 1; i < count; ++i) {
+        lower.x = min(lower.x, origins[i].x), lower.y = min(lower.y, origins[i].y);
+        upper.x = max(upper.x, origins[i].x), upper.y = max(upper.y, origins[i].y);
+    }
+    Vector2 keyScale(upper.x > lower.x ? 1/(upper.x-lower.x) : 0, upper.y > lower.y ? 1/(upper.y-lower.y) : 0);
+    workspace.batchOrder.resize(count);
+    for (int i = 0; i < count; ++i) {
+        unsigned x = (unsigned) (0xffff*clamp(keyScale.x*(origins[i].x-lower.x)));
+        unsigned y = (unsigned) (0xffff*clamp(keyScale.y*(origins[i].y-lower.y)));
+        workspace.batchOrder[i] = std::make_pair(spreadBits(x)|spreadBits(y)<<1, i);
+    }
+    std::sort(workspace.batchOrder.begin(), workspace.batchOrder.end());
+    for (std::vector<std::pair<unsigned, int> >::const_iterator entry = workspace.batchOrder.begin(); entry != workspace.batchOrder.end(); ++entry)
+        distances[entry->second] = distance(workspace, origins[entry->second]);
+}
+
+template <class ContourCombiner>
+void ShapeDistanceQuery<ContourCombiner>::distances(DistanceType *distances, const Point2 *origins, int count) const {
+    Workspace workspace(*this);
+    this->distances(workspace, distances, origins, count);
+}
+
+template <class ContourCombiner>
+unsigned ShapeDistanceQuery<ContourCombiner>::spreadBits(unsigned x) {
+    x &= 0xffffu;
+    x = (x|x<<8)&0x00ff00ffu;
+    x = (x|x<<4)&0x0f0f0f0fu;
+    x = (x|x<<2)&0x33333333u;
+    x = (x|x<<1)&0x55555555u;
+    return x;
+}
+
+template <class ContourCombiner>
+bool ShapeDistanceQuery<ContourCombiner>::addRelevantContours(Workspace &workspace) const {
+    bool added = false;
+    for (int i = 0; i < int(shape.contours.size()); ++i) {
+        if (contourEdgeBounds[i+1] > contourEdgeBounds[i] && workspace.contourCombiner.isContourRelevant(i)) {
+            addEdges(workspace, workspace.contourCombiner.edgeSelector(i), contourEdgeBounds[i], contourEdgeBounds[i+1]);
+            added = true;
+        }
+    }
+    return added;
+}
+
+template <class ContourCombiner>
+void ShapeDistanceQuery<ContourCombiner>::addEdges(Workspace &workspace, typename ContourCombiner::EdgeSelectorType &edgeSelector, int begin, int end) const {
+    for (int i = begin; i < end; ++i) {
+        const EdgeNeighborhood &neighborhood = edges[i];
+        switch (neighborhood.type) {
+            case LinearSegment::EDGE_TYPE:
+                edgeSelector.addEdge(workspace.edgeCache[i], neighborhood.prevEdge, static_cast<const LinearSegment *>(neighborhood.edge), neighborhood.nextEdge);
+                break;
+            case QuadraticSegment::EDGE_TYPE:
+                edgeSelector.addEdge(workspace.edgeCache[i], neighborhood.prevEdge, static_cast<const QuadraticSegment *>(neighborhood.edge), neighborhood.nextEdge);
+                break;
+            case CubicSegment::EDGE_TYPE:
+                edgeSelector.addEdge(workspace.edgeCache[i], neighborhood.prevEdge, static_cast<const CubicSegment *>(neighborhood.edge), neighborhood.nextEdge);
+                break;
+        }
+    }
+}
+
+}
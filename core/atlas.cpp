@@ -0,0 +1,96 @@
+
+#include "atlas.h"
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "arithmetics.hpp"
+#include "../msdfgen.h"
+
+// Expected fraction of the atlas area that shelf packing fills, used to estimate its width
+#define ATLAS_PACKING_EFFICIENCY .85
+
+namespace msdfgen {
+
+class TallerRegion {
+    const AtlasRegion *regions;
+public:
+    inline explicit TallerRegion(const AtlasRegion *regions) : regions(regions) { }
+    inline bool operator()(int a, int b) const {
+        if (regions[a].height != regions[b].height)
+            return regions[a].height > regions[b].height;
+        return regions[a].width > regions[b].width;
+    }
+};
+
+void packAtlas(AtlasRegion *regions, int &width, int &height, const Shape *shapes, int shapeCount, double scale, Range pxRange, int spacing) {
+    double padding = max(-pxRange.lower, 0.);
+    std::vector<int> order;
+    double area = 0;
+    int maxWidth = 0;
+    for (int i = 0; i < shapeCount; ++i) {
+        AtlasRegion &region = regions[i];
+        Shape::Bounds bounds = shapes[i].getBounds();
+        region.x = 0, region.y = 0, region.width = 0, region.height = 0;
+        region.translate = Vector2();
+        if (!(bounds.l < bounds.r && bounds.b < bounds.t))
+            continue;
+        Vector2 frame(scale*(bounds.r-bounds.l)+2*padding, scale*(bounds.t-bounds.b)+2*padding);
+        region.width = (int) ceil(frame.x);
+        region.height = (int) ceil(frame.y);
+        region.translate = Vector2(.5*(region.width-frame.x)+padding, .5*(region.height-frame.y)+padding)/scale-Vector2(bounds.l, bounds.b);
+        order.push_back(i);
+        area += double(region.width+spacing)*double(region.height+spacing);
+        maxWidth = max(maxWidth, region.width);
+    }
+
+    // Shelf packing in order of decreasing height
+    std::sort(order.begin(), order.end(), TallerRegion(regions));
+    width = max(maxWidth, (int) ceil(sqrt(area/ATLAS_PACKING_EFFICIENCY)));
+    height = 0;
+    int x = 0, shelfY = 0;
+    for (std::vector<int>::const_iterator index = order.begin(); index != order.end(); ++index) {
+        AtlasRegion &region = regions[*index];
+        if (x > 0 && x+region.width > width) {
+            x = 0;
+            shelfY = height+spacing;
+        }
+        region.x = x;
+        region.y = shelfY;
+        x += region.width+spacing;
+        height = max(height, shelfY+region.height);
+    }
+}
+
+template <typename T, int N, typename ConfigType>
+static void generateAtlas(void (*generator)(const BitmapSection<T, N> &, const Shape &, const SDFTransformation &, const ConfigType &), const BitmapSection<T, N> &atlas, const Shape *shapes, const AtlasRegion *regions, int shapeCount, double scale, Range pxRange, const ConfigType &config) {
+    // Regions are generated in parallel, while the generator's own parallel region runs in the calling thread
+#ifdef MSDFGEN_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = 0; i < shapeCount; ++i) {
+        const AtlasRegion &region = regions[i];
+        if (region.width > 0 && region.height > 0) {
+            SDFTransformation transformation(Projection(scale, region.translate), pxRange/scale);
+            generator(atlas.getSection(region.x, region.y, region.x+region.width, region.y+region.height), shapes[i], transformation, config);
+        }
+    }
+}
+
+void generateAtlasSDF(const BitmapSection<float, 1> &atlas, const Shape *shapes, const AtlasRegion *regions, int shapeCount, double scale, Range pxRange, const GeneratorConfig &config) {
+    generateAtlas<float, 1, GeneratorConfig>(&generateSDF, atlas, shapes, regions, shapeCount, scale, pxRange, config);
+}
+
+void generateAtlasPSDF(const BitmapSection<float, 1> &atlas, const Shape *shapes, const AtlasRegion *regions, int shapeCount, double scale, Range pxRange, const GeneratorConfig &config) {
+    generateAtlas<float, 1, GeneratorConfig>(&generatePSDF, atlas, shapes, regions, shapeCount, scale, pxRange, config);
+}
+
+void generateAtlasMSDF(const BitmapSection<float, 3> &atlas, const Shape *shapes, const AtlasRegion *regions, int shapeCount, double scale, Range pxRange, const MSDFGeneratorConfig &config) {
+    generateAtlas<float, 3, MSDFGeneratorConfig>(&generateMSDF, atlas, shapes, regions, shapeCount, scale, pxRange, config);
+}
+
+void generateAtlasMTSDF(const BitmapSection<float, 4> &atlas, const Shape *shapes, const AtlasRegion *regions, int shapeCount, double scale, Range pxRange, const MSDFGeneratorConfig &config) {
+    generateAtlas<float, 4, MSDFGeneratorConfig>(&generateMTSDF, atlas, shapes, regions, shapeCount, scale, pxRange, config);
+}
+
+}
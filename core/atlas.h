@@ -0,0 +1,28 @@
+
+#pragma once
+
+#include "Vector2.hpp"
+#include "Range.hpp"
+#include "Shape.h"
+#include "BitmapRef.hpp"
+#include "generator-config.h"
+
+namespace msdfgen {
+
+/// Rectangle of an atlas assigned to a shape, and the translation that places the shape in its center at the atlas scale.
+struct AtlasRegion {
+    int x, y, width, height;
+    Vector2 translate;
+};
+
+/// Assigns a region to each shape, which fits its bounds at the given scale padded by the outer part of the pixel range, and packs the regions into an atlas of approximately square dimensions, which are output into width and height.
+/// Regions are separated by spacing pixels. Empty shapes receive empty regions.
+void packAtlas(AtlasRegion *regions, int &width, int &height, const Shape *shapes, int shapeCount, double scale, Range pxRange, int spacing = 0);
+
+/// Generates distance fields of shapes directly into their regions of the atlas in parallel. Pixels outside of the regions are left untouched.
+void generateAtlasSDF(const BitmapSection<float, 1> &atlas, const Shape *shapes, const AtlasRegion *regions, int shapeCount, double scale, Range pxRange, const GeneratorConfig &config = GeneratorConfig());
+void generateAtlasPSDF(const BitmapSection<float, 1> &atlas, const Shape *shapes, const AtlasRegion *regions, int shapeCount, double scale, Range pxRange, const GeneratorConfig &config = GeneratorConfig());
+void generateAtlasMSDF(const BitmapSection<float, 3> &atlas, const Shape *shapes, const AtlasRegion *regions, int shapeCount, double scale, Range pxRange, const MSDFGeneratorConfig &config = MSDFGeneratorConfig());
+void generateAtlasMTSDF(const BitmapSection<float, 4> &atlas, const Shape *shapes, const AtlasRegion *regions, int shapeCount, double scale, Range pxRange, const MSDFGeneratorConfig &config = MSDFGeneratorConfig());
+
+}
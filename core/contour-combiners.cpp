@@ -2,6 +2,7 @@
 #include "contour-combiners.h"
 
 #include <cfloat>
+#include <algorithm>
 #include "arithmetics.hpp"
 
 namespace msdfgen {
@@ -23,20 +24,69 @@ static void initDistance(MultiAndTrueDistance &distance) {
     distance.a = -DBL_MAX;
 }
 
+static void initDistance(EdgeDistance &distance) {
+    distance.distance = -DBL_MAX;
+    distance.edge = NULL;
+    distance.param = 0;
+}
+
+static void initDistance(GradientDistance &distance) {
+    distance.distance = -DBL_MAX;
+    distance.gradient = Vector2();
+}
+
 static double resolveDistance(double distance) {
     return distance;
 }
 
+static double resolveDistance(const EdgeDistance &distance) {
+    return distance.distance;
+}
+
+static double resolveDistance(const GradientDistance &distance) {
+    return distance.distance;
+}
+
 static double resolveDistance(const MultiDistance &distance) {
     return median(distance.r, distance.g, distance.b);
 }
 
+static double maxAbsDistance(double distance) {
+    return fabs(distance);
+}
+
+static double maxAbsDistance(const EdgeDistance &distance) {
+    return fabs(distance.distance);
+}
+
+static double maxAbsDistance(const GradientDistance &distance) {
+    return fabs(distance.distance);
+}
+
+static double maxAbsDistance(const MultiDistance &distance) {
+    return max(fabs(distance.r), max(fabs(distance.g), fabs(distance.b)));
+}
+
+static double maxAbsDistance(const MultiAndTrueDistance &distance) {
+    return max(maxAbsDistance(static_cast<const MultiDistance &>(distance)), fabs(distance.a));
+}
+
 template <class EdgeSelector>
-SimpleContourCombiner<EdgeSelector>::SimpleContourCombiner(const Shape &) { }
+SimpleContourCombiner<EdgeSelector>::SimpleContourCombiner(const Shape &) : nextContour(0) { }
 
 template <class EdgeSelector>
 void SimpleContourCombiner<EdgeSelector>::reset(const Point2 &p) {
     shapeEdgeSelector.reset(p);
+    nextContour = 0;
+}
+
+template <class EdgeSelector>
+bool SimpleContourCombiner<EdgeSelector>::isContourRelevant(int i) {
+    // Contours are evaluated in order, so those before nextContour have already been evaluated
+    if (i < nextContour)
+        return false;
+    nextContour = i+1;
+    return true;
 }
 
 template <class EdgeSelector>
@@ -50,23 +100,70 @@ typename SimpleContourCombiner<EdgeSelector>::DistanceType SimpleContourCombiner
 }
 
 template class SimpleContourCombiner<TrueDistanceSelector>;
+template class SimpleContourCombiner<NearestEdgeSelector>;
+template class SimpleContourCombiner<GradientDistanceSelector>;
 template class SimpleContourCombiner<PerpendicularDistanceSelector>;
 template class SimpleContourCombiner<MultiDistanceSelector>;
 template class SimpleContourCombiner<MultiAndTrueDistanceSelector>;
 
+/// Returns whether the edge selector measures true distance, which the bounding box of a contour bounds, unlike pseudo-distance that extends past the edges' endpoints.
+static bool measuresTrueDistance(const TrueDistanceSelector *) {
+    return true;
+}
+
+static bool measuresTrueDistance(const NearestEdgeSelector *) {
+    return true;
+}
+
+static bool measuresTrueDistance(const void *) {
+    return false;
+}
+
 template <class EdgeSelector>
-OverlappingContourCombiner<EdgeSelector>::OverlappingContourCombiner(const Shape &shape) {
+OverlappingContourCombiner<EdgeSelector>::OverlappingContourCombiner(const Shape &shape) : pruneContours(measuresTrueDistance((const EdgeSelector *) NULL)), distanceBound(DBL_MAX) {
     windings.reserve(shape.contours.size());
-    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour)
+    contourBounds.reserve(shape.contours.size());
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
         windings.push_back(contour->winding());
+        // The range of the control points encloses the contour regardless of numerical precision of its exact bounds
+        Shape::Bounds bounds = { DBL_MAX, DBL_MAX, -DBL_MAX, -DBL_MAX };
+        for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+            const Point2 *p = (*edge)->controlPoints();
+            for (int i = 0; i <= (*edge)->type(); ++i) {
+                bounds.l = min(bounds.l, p[i].x), bounds.b = min(bounds.b, p[i].y);
+                bounds.r = max(bounds.r, p[i].x), bounds.t = max(bounds.t, p[i].y);
+            }
+        }
+        contourBounds.push_back(bounds);
+    }
     edgeSelectors.resize(shape.contours.size());
+    evaluated.resize(shape.contours.size());
 }
 
 template <class EdgeSelector>
 void OverlappingContourCombiner<EdgeSelector>::reset(const Point2 &p) {
+    // The previous point's distance bound is likely to hold for nearby points, otherwise further contours are evaluated after distance()
+    distanceBound += (p-this->p).length();
     this->p = p;
     for (typename std::vector<EdgeSelector>::iterator contourEdgeSelector = edgeSelectors.begin(); contourEdgeSelector != edgeSelectors.end(); ++contourEdgeSelector)
         contourEdgeSelector->reset(p);
+    std::fill(evaluated.begin(), evaluated.end(), 0);
+}
+
+template <class EdgeSelector>
+bool OverlappingContourCombiner<EdgeSelector>::isContourRelevant(int i) {
+    if (evaluated[i])
+        return false;
+    if (!pruneContours) {
+        evaluated[i] = true;
+        return true;
+    }
+    const Shape::Bounds &bounds = contourBounds[i];
+    double dx = max(bounds.l-p.x, p.x-bounds.r), dy = max(bounds.b-p.y, p.y-bounds.t);
+    if ((dx > 0 && dx > distanceBound) || (dy > 0 && dy > distanceBound) || (dx > 0 && dy > 0 && dx*dx+dy*dy > distanceBound*distanceBound))
+        return false;
+    evaluated[i] = true;
+    return true;
 }
 
 template <class EdgeSelector>
@@ -75,7 +172,7 @@ EdgeSelector &OverlappingContourCombiner<EdgeSelector>::edgeSelector(int i) {
 }
 
 template <class EdgeSelector>
-typename OverlappingContourCombiner<EdgeSelector>::DistanceType OverlappingContourCombiner<EdgeSelector>::distance() const {
+typename OverlappingContourCombiner<EdgeSelector>::DistanceType OverlappingContourCombiner<EdgeSelector>::distance() {
     int contourCount = (int) edgeSelectors.size();
     EdgeSelector shapeEdgeSelector;
     EdgeSelector innerEdgeSelector;
@@ -84,6 +181,8 @@ typename OverlappingContourCombiner<EdgeSelector>::DistanceType OverlappingConto
     innerEdgeSelector.reset(p);
     outerEdgeSelector.reset(p);
     for (int i = 0; i < contourCount; ++i) {
+        if (!evaluated[i])
+            continue;
         DistanceType edgeDistance = edgeSelectors[i].distance();
         shapeEdgeSelector.merge(edgeSelectors[i]);
         if (windings[i] > 0 && resolveDistance(edgeDistance) >= 0)
@@ -105,7 +204,7 @@ typename OverlappingContourCombiner<EdgeSelector>::DistanceType OverlappingConto
         distance = innerDistance;
         winding = 1;
         for (int i = 0; i < contourCount; ++i)
-            if (windings[i] > 0) {
+            if (evaluated[i] && windings[i] > 0) {
                 DistanceType contourDistance = edgeSelectors[i].distance();
                 if (fabs(resolveDistance(contourDistance)) < fabs(outerScalarDistance) && resolveDistance(contourDistance) > resolveDistance(distance))
                     distance = contourDistance;
@@ -114,26 +213,32 @@ typename OverlappingContourCombiner<EdgeSelector>::DistanceType OverlappingConto
         distance = outerDistance;
         winding = -1;
         for (int i = 0; i < contourCount; ++i)
-            if (windings[i] < 0) {
+            if (evaluated[i] && windings[i] < 0) {
                 DistanceType contourDistance = edgeSelectors[i].distance();
                 if (fabs(resolveDistance(contourDistance)) < fabs(innerScalarDistance) && resolveDistance(contourDistance) < resolveDistance(distance))
                     distance = contourDistance;
             }
-    } else
+    } else {
+        distanceBound = max(shapeEdgeSelector.trueDistanceBound(), maxAbsDistance(shapeDistance));
         return shapeDistance;
+    }
 
     for (int i = 0; i < contourCount; ++i)
-        if (windings[i] != winding) {
+        if (evaluated[i] && windings[i] != winding) {
             DistanceType contourDistance = edgeSelectors[i].distance();
             if (resolveDistance(contourDistance)*resolveDistance(distance) >= 0 && fabs(resolveDistance(contourDistance)) < fabs(resolveDistance(distance)))
                 distance = contourDistance;
         }
     if (resolveDistance(distance) == resolveDistance(shapeDistance))
         distance = shapeDistance;
+    // Unevaluated contours are farther than any edge that may have affected the result
+    distanceBound = max(shapeEdgeSelector.trueDistanceBound(), maxAbsDistance(distance));
     return distance;
 }
 
 template class OverlappingContourCombiner<TrueDistanceSelector>;
+template class OverlappingContourCombiner<NearestEdgeSelector>;
+template class OverlappingContourCombiner<GradientDistanceSelector>;
 template class OverlappingContourCombiner<PerpendicularDistanceSelector>;
 template class OverlappingContourCombiner<MultiDistanceSelector>;
 template class OverlappingContourCombiner<MultiAndTrueDistanceSelector>;
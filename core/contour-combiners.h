@@ -16,11 +16,14 @@ public:
 
     explicit SimpleContourCombiner(const Shape &shape);
     void reset(const Point2 &p);
+    /// Returns true if contour i hasn't been evaluated yet for the current point and marks it as evaluated.
+    bool isContourRelevant(int i);
     EdgeSelector &edgeSelector(int i);
     DistanceType distance() const;
 
 private:
     EdgeSelector shapeEdgeSelector;
+    int nextContour;
 
 };
 
@@ -34,13 +37,23 @@ public:
 
     explicit OverlappingContourCombiner(const Shape &shape);
     void reset(const Point2 &p);
+    /// Returns true if contour i hasn't been evaluated yet for the current point and may affect the distance, in which case it is marked as evaluated.
+    bool isContourRelevant(int i);
     EdgeSelector &edgeSelector(int i);
-    DistanceType distance() const;
+    /// Combines the distances of the evaluated contours and narrows the distance bound to the result.
+    /// Afterwards, further contours may become relevant if the result turns out to be farther than anticipated.
+    DistanceType distance();
 
 private:
     Point2 p;
     std::vector<int> windings;
     std::vector<EdgeSelector> edgeSelectors;
+    std::vector<Shape::Bounds> contourBounds;
+    std::vector<char> evaluated;
+    // Contours are only skipped for true distance, since the pseudo-distance of any contour may be nearer than its bounding box
+    bool pruneContours;
+    // Contours whose bounding box is farther than this cannot affect the distance
+    double distanceBound;
 
 };
 
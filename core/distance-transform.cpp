@@ -0,0 +1,136 @@
+
+#include "distance-transform.h"
+
+#include <cmath>
+#include <cfloat>
+#include <climits>
+#include <vector>
+#include "arithmetics.hpp"
+
+// Number of adjacent columns swept together, so that the sweeps read contiguous runs of each row
+#define EDT_COLUMN_BLOCK 256
+
+namespace msdfgen {
+
+/// Computes the squared distance of each of n samples spaced by step to the nearest feature, whose squared distances are in f and DBL_MAX elsewhere, as the lower envelope of parabolas (Felzenszwalb & Huttenlocher).
+static void distanceTransform(double *d, const double *f, int n, double step, int *v, double *z) {
+    int k = -1;
+    for (int q = 0; q < n; ++q) {
+        if (f[q] == DBL_MAX)
+            continue;
+        double s = -DBL_MAX;
+        // Remove parabolas which are below the new one to the right of where they intersect with their predecessor
+        while (k >= 0) {
+            s = ((f[q]+(q*step)*(q*step))-(f[v[k]]+(v[k]*step)*(v[k]*step)))/(2*step*(q-v[k]));
+            if (s > z[k])
+                break;
+            --k;
+        }
+        if (k < 0)
+            s = -DBL_MAX;
+        ++k;
+        v[k] = q;
+        z[k] = s;
+    }
+    if (k < 0) {
+        for (int q = 0; q < n; ++q)
+            d[q] = DBL_MAX;
+        return;
+    }
+    for (int q = 0, j = 0; q < n; ++q) {
+        while (j < k && z[j+1] < q*step)
+            ++j;
+        double dx = (q-v[j])*step;
+        d[q] = dx*dx+f[v[j]];
+    }
+}
+
+bool generateSDFFromBitmap(const BitmapSection<float, 1> &outputSection, const BitmapConstSection<float, 1> &maskSection, const SDFTransformation &transformation, float threshold) {
+    BitmapSection<float, 1> output = outputSection;
+    BitmapConstSection<float, 1> mask = maskSection;
+    if (!(output.width > 0 && output.height > 0))
+        return mask.width == 0 && mask.height == 0;
+    int supersampling = mask.width/output.width;
+    if (!(supersampling > 0 && mask.width == supersampling*output.width && mask.height == supersampling*output.height))
+        return false;
+    mask.reorient(output.yOrientation);
+    int w = mask.width, h = mask.height;
+    Vector2 texelSize = transformation.unprojectVector(Vector2(1./supersampling));
+    double stepX = fabs(texelSize.x), stepY = fabs(texelSize.y);
+    // The boundary is assumed halfway between the centers of an inside and an outside texel
+    double boundaryOffset = .5*min(stepX, stepY);
+    // Output pixels take the distances of the one or two by two texels at their center
+    int centerLow = (supersampling-1)>>1, centerHigh = supersampling>>1, centerRows = centerHigh-centerLow+1;
+    double averagingFactor = 1./(centerRows*centerRows);
+    // Number of texels to the nearest inside and outside texel in the same column, interleaved, in the center rows of each output row
+    std::vector<int> columnDistances(2*(size_t) w*centerRows*output.height);
+#ifdef MSDFGEN_USE_OPENMP
+    #pragma omp parallel
+#endif
+    {
+        // Rows of the last texels of either class swept over in each column
+        std::vector<int> lastRows(2*EDT_COLUMN_BLOCK);
+#ifdef MSDFGEN_USE_OPENMP
+        #pragma omp for
+#endif
+        for (int x0 = 0; x0 < w; x0 += EDT_COLUMN_BLOCK) {
+            int columns = min(EDT_COLUMN_BLOCK, w-x0);
+            for (int i = 0; i < 2*columns; ++i)
+                lastRows[i] = -1;
+            for (int y = 0; y < h; ++y) {
+                for (int i = 0; i < columns; ++i)
+                    lastRows[2*i+(*mask(x0+i, y) <= threshold)] = y;
+                int row = y%supersampling-centerLow;
+                if (row >= 0 && row < centerRows) {
+                    int *distances = &columnDistances[2*((size_t) w*(centerRows*(y/supersampling)+row)+x0)];
+                    for (int i = 0; i < 2*columns; ++i)
+                        distances[i] = lastRows[i] >= 0 ? y-lastRows[i] : INT_MAX;
+                }
+            }
+            for (int i = 0; i < 2*columns; ++i)
+                lastRows[i] = -1;
+            for (int y = h-1; y >= 0; --y) {
+                for (int i = 0; i < columns; ++i)
+                    lastRows[2*i+(*mask(x0+i, y) <= threshold)] = y;
+                int row = y%supersampling-centerLow;
+                if (row >= 0 && row < centerRows) {
+                    int *distances = &columnDistances[2*((size_t) w*(centerRows*(y/supersampling)+row)+x0)];
+                    for (int i = 0; i < 2*columns; ++i) {
+                        if (lastRows[i] >= 0 && lastRows[i]-y < distances[i])
+                            distances[i] = lastRows[i]-y;
+                    }
+                }
+            }
+        }
+        std::vector<double> f(w), d(w), z(w), sums(output.width);
+        std::vector<int> v(w);
+#ifdef MSDFGEN_USE_OPENMP
+        #pragma omp for
+#endif
+        for (int y = 0; y < output.height; ++y) {
+            for (int x = 0; x < output.width; ++x)
+                sums[x] = 0;
+            for (int row = 0; row < centerRows; ++row) {
+                int sy = supersampling*y+centerLow+row;
+                const int *rowDistances = &columnDistances[2*(size_t) w*(centerRows*y+row)];
+                // Outside texels are assigned the negative distance to the nearest inside texel and vice versa
+                for (int i = 0; i < 2; ++i) {
+                    for (int sx = 0; sx < w; ++sx)
+                        f[sx] = rowDistances[2*sx+i] != INT_MAX ? (rowDistances[2*sx+i]*stepY)*(rowDistances[2*sx+i]*stepY) : DBL_MAX;
+                    distanceTransform(&d[0], &f[0], w, stepX, &v[0], &z[0]);
+                    for (int x = 0; x < output.width; ++x) {
+                        for (int sx = supersampling*x+centerLow; sx <= supersampling*x+centerHigh; ++sx) {
+                            if ((*mask(sx, sy) > threshold) == (i != 0))
+                                sums[x] += (i ? averagingFactor : -averagingFactor)*(sqrt(d[sx])-boundaryOffset);
+                        }
+                    }
+                }
+            }
+            for (int x = 0; x < output.width; ++x)
+                *output(x, y) = float(transformation.distanceMapping(sums[x]));
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,17 @@
+
+#pragma once
+
+#include "BitmapRef.hpp"
+#include "SDFTransformation.h"
+
+namespace msdfgen {
+
+/**
+ * Generates a signed distance field from a monochrome mask, whose texels with values above threshold are inside,
+ * by an exact Euclidean distance transform between the centers of inside and outside texels, which runs in linear time.
+ * The mask may be supersampled, i.e. its dimensions may be the same integer multiple of the output's, in which case each output pixel averages the distances of the one or two by two texels at its center.
+ * Only the scale of transformation's projection is used to convert pixels to shape units. Returns false if the mask's dimensions are not a multiple of the output's.
+ */
+bool generateSDFFromBitmap(const BitmapSection<float, 1> &output, const BitmapConstSection<float, 1> &mask, const SDFTransformation &transformation, float threshold = .5f);
+
+}
@@ -7,6 +7,7 @@
 #include <cfloat>
 #include <vector>
 #include <queue>
+#include <algorithm>
 #include "arithmetics.hpp"
 
 namespace msdfgen {
@@ -260,6 +261,8 @@ void edgeColoringInkTrap(Shape &shape, double angleThreshold, unsigned long long
 // EDGE COLORING BY DISTANCE - EXPERIMENTAL IMPLEMENTATION - WORK IN PROGRESS
 #define MAX_RECOLOR_STEPS 16
 #define EDGE_DISTANCE_PRECISION 16
+// Pairs of splines farther apart than this multiple of the median spline size are not considered.
+#define EDGE_DISTANCE_CUTOFF_FACTOR 4
 
 static double edgeToEdgeDistance(const EdgeSegment &a, const EdgeSegment &b, int precision) {
     if (a.point(0) == b.point(0) || a.point(0) == b.point(1) || a.point(1) == b.point(0) || a.point(1) == b.point(1))
@@ -289,13 +292,11 @@ static double splineToSplineDistance(EdgeSegment *const *edgeSegments, int aStar
     return minDistance;
 }
 
-static void colorSecondDegreeGraph(int *coloring, const int *const *edgeMatrix, int vertexCount, unsigned long long seed) {
+static void colorSecondDegreeGraph(int *coloring, const std::vector<int> *adjacency, int vertexCount, unsigned long long seed) {
     for (int i = 0; i < vertexCount; ++i) {
         int possibleColors = 7;
-        for (int j = 0; j < i; ++j) {
-            if (edgeMatrix[i][j])
-                possibleColors &= ~(1<<coloring[j]);
-        }
+        for (std::vector<int>::const_iterator j = adjacency[i].begin(); j != adjacency[i].end() && *j < i; ++j)
+            possibleColors &= ~(1<<coloring[*j]);
         int color = 0;
         switch (possibleColors) {
             case 1:
@@ -324,72 +325,173 @@ static void colorSecondDegreeGraph(int *coloring, const int *const *edgeMatrix,
     }
 }
 
-static int vertexPossibleColors(const int *coloring, const int *edgeVector, int vertexCount) {
+static int vertexPossibleColors(const int *coloring, const std::vector<int> &neighbors) {
     int usedColors = 0;
-    for (int i = 0; i < vertexCount; ++i)
-        if (edgeVector[i])
-            usedColors |= 1<<coloring[i];
+    for (std::vector<int>::const_iterator i = neighbors.begin(); i != neighbors.end(); ++i)
+        if (coloring[*i] >= 0)
+            usedColors |= 1<<coloring[*i];
     return 7&~usedColors;
 }
 
-static void uncolorSameNeighbors(std::queue<int> &uncolored, int *coloring, const int *const *edgeMatrix, int vertex, int vertexCount) {
-    for (int i = vertex+1; i < vertexCount; ++i) {
-        if (edgeMatrix[vertex][i] && coloring[i] == coloring[vertex]) {
-            coloring[i] = -1;
-            uncolored.push(i);
+static bool isAdjacent(const std::vector<int> *adjacency, int vertexA, int vertexB) {
+    return std::binary_search(adjacency[vertexA].begin(), adjacency[vertexA].end(), vertexB);
+}
+
+static void addAdjacency(std::vector<int> *adjacency, int vertexA, int vertexB) {
+    adjacency[vertexA].insert(std::lower_bound(adjacency[vertexA].begin(), adjacency[vertexA].end(), vertexB), vertexB);
+    adjacency[vertexB].insert(std::lower_bound(adjacency[vertexB].begin(), adjacency[vertexB].end(), vertexA), vertexA);
+}
+
+static void removeAdjacency(std::vector<int> *adjacency, int vertexA, int vertexB) {
+    adjacency[vertexA].erase(std::lower_bound(adjacency[vertexA].begin(), adjacency[vertexA].end(), vertexB));
+    adjacency[vertexB].erase(std::lower_bound(adjacency[vertexB].begin(), adjacency[vertexB].end(), vertexA));
+}
+
+/// Changes the color of a vertex while recording its previous color so that the change can be reverted.
+static void recolor(int *coloring, std::vector<std::pair<int, int> > &changes, int vertex, int color) {
+    changes.push_back(std::make_pair(vertex, coloring[vertex]));
+    coloring[vertex] = color;
+}
+
+static void uncolorSameNeighbors(std::queue<int> &uncolored, int *coloring, std::vector<std::pair<int, int> > &changes, const std::vector<int> *adjacency, int vertex) {
+    // Neighbors with a higher index are visited first
+    std::vector<int>::const_iterator split = std::upper_bound(adjacency[vertex].begin(), adjacency[vertex].end(), vertex);
+    for (std::vector<int>::const_iterator i = split; i != adjacency[vertex].end(); ++i) {
+        if (coloring[*i] == coloring[vertex]) {
+            recolor(coloring, changes, *i, -1);
+            uncolored.push(*i);
         }
     }
-    for (int i = 0; i < vertex; ++i) {
-        if (edgeMatrix[vertex][i] && coloring[i] == coloring[vertex]) {
-            coloring[i] = -1;
-            uncolored.push(i);
+    for (std::vector<int>::const_iterator i = adjacency[vertex].begin(); i != split; ++i) {
+        if (coloring[*i] == coloring[vertex]) {
+            recolor(coloring, changes, *i, -1);
+            uncolored.push(*i);
         }
     }
 }
 
-static bool tryAddEdge(int *coloring, int *const *edgeMatrix, int vertexCount, int vertexA, int vertexB, int *coloringBuffer) {
+static bool tryAddEdge(int *coloring, std::vector<int> *adjacency, int vertexA, int vertexB, std::vector<std::pair<int, int> > &changes) {
     static const int FIRST_POSSIBLE_COLOR[8] = { -1, 0, 1, 0, 2, 2, 1, 0 };
-    edgeMatrix[vertexA][vertexB] = 1;
-    edgeMatrix[vertexB][vertexA] = 1;
+    addAdjacency(adjacency, vertexA, vertexB);
     if (coloring[vertexA] != coloring[vertexB])
         return true;
-    int bPossibleColors = vertexPossibleColors(coloring, edgeMatrix[vertexB], vertexCount);
+    int bPossibleColors = vertexPossibleColors(coloring, adjacency[vertexB]);
     if (bPossibleColors) {
         coloring[vertexB] = FIRST_POSSIBLE_COLOR[bPossibleColors];
         return true;
     }
-    memcpy(coloringBuffer, coloring, sizeof(int)*vertexCount);
+    changes.clear();
     std::queue<int> uncolored;
-    {
-        int *coloring = coloringBuffer;
-        coloring[vertexB] = FIRST_POSSIBLE_COLOR[7&~(1<<coloring[vertexA])];
-        uncolorSameNeighbors(uncolored, coloring, edgeMatrix, vertexB, vertexCount);
-        int step = 0;
-        while (!uncolored.empty() && step < MAX_RECOLOR_STEPS) {
-            int i = uncolored.front();
-            uncolored.pop();
-            int possibleColors = vertexPossibleColors(coloring, edgeMatrix[i], vertexCount);
-            if (possibleColors) {
-                coloring[i] = FIRST_POSSIBLE_COLOR[possibleColors];
-                continue;
-            }
-            do {
-                coloring[i] = step++%3;
-            } while (edgeMatrix[i][vertexA] && coloring[i] == coloring[vertexA]);
-            uncolorSameNeighbors(uncolored, coloring, edgeMatrix, i, vertexCount);
+    recolor(coloring, changes, vertexB, FIRST_POSSIBLE_COLOR[7&~(1<<coloring[vertexA])]);
+    uncolorSameNeighbors(uncolored, coloring, changes, adjacency, vertexB);
+    int step = 0;
+    while (!uncolored.empty() && step < MAX_RECOLOR_STEPS) {
+        int i = uncolored.front();
+        uncolored.pop();
+        int possibleColors = vertexPossibleColors(coloring, adjacency[i]);
+        if (possibleColors) {
+            recolor(coloring, changes, i, FIRST_POSSIBLE_COLOR[possibleColors]);
+            continue;
         }
+        bool adjacentToA = isAdjacent(adjacency, i, vertexA);
+        int color;
+        do {
+            color = step++%3;
+        } while (adjacentToA && color == coloring[vertexA]);
+        recolor(coloring, changes, i, color);
+        uncolorSameNeighbors(uncolored, coloring, changes, adjacency, i);
     }
     if (!uncolored.empty()) {
-        edgeMatrix[vertexA][vertexB] = 0;
-        edgeMatrix[vertexB][vertexA] = 0;
+        // Revert the changes in reverse order
+        for (std::vector<std::pair<int, int> >::reverse_iterator change = changes.rbegin(); change != changes.rend(); ++change)
+            coloring[change->first] = change->second;
+        removeAdjacency(adjacency, vertexA, vertexB);
         return false;
     }
-    memcpy(coloring, coloringBuffer, sizeof(int)*vertexCount);
     return true;
 }
 
-static int cmpDoublePtr(const void *a, const void *b) {
-    return sign(**reinterpret_cast<const double *const *>(a)-**reinterpret_cast<const double *const *>(b));
+struct SplinePair {
+    double distance;
+    int a, b;
+};
+
+static int cmpSplinePairs(const void *a, const void *b) {
+    return sign(reinterpret_cast<const SplinePair *>(a)->distance-reinterpret_cast<const SplinePair *>(b)->distance);
+}
+
+static double boundsDistance(const Shape::Bounds &a, const Shape::Bounds &b) {
+    double dx = max(0., max(a.l-b.r, b.l-a.r));
+    double dy = max(0., max(a.b-b.t, b.b-a.t));
+    return sqrt(dx*dx+dy*dy);
+}
+
+/// Finds all pairs of splines whose bounding boxes are within cutoffDistance of each other using a uniform grid, in the order of (a, b), a < b.
+static void findNearbySplinePairs(std::vector<SplinePair> &pairs, const std::vector<Shape::Bounds> &splineBounds, double cutoffDistance) {
+    int splineCount = (int) splineBounds.size();
+    Shape::Bounds total = { DBL_MAX, DBL_MAX, -DBL_MAX, -DBL_MAX };
+    for (int i = 0; i < splineCount; ++i) {
+        total.l = min(total.l, splineBounds[i].l), total.b = min(total.b, splineBounds[i].b);
+        total.r = max(total.r, splineBounds[i].r), total.t = max(total.t, splineBounds[i].t);
+    }
+    // The cell size is at least the cutoff distance but the number of cells is limited to be proportional to the number of splines
+    double cellSize = max(cutoffDistance, max(total.r-total.l, total.t-total.b)/(sqrt((double) splineCount)+1));
+    if (!(cellSize > 0))
+        cellSize = 1;
+    int gridWidth = (int) ((total.r-total.l)/cellSize)+1, gridHeight = (int) ((total.t-total.b)/cellSize)+1;
+
+    // Cells are stored as ranges of a single list of spline indices
+    std::vector<int> cellStarts(gridWidth*gridHeight+1);
+    std::vector<int> cellSplines;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int i = 0; i < splineCount; ++i) {
+            int l = (int) ((splineBounds[i].l-total.l)/cellSize), r = (int) ((splineBounds[i].r-total.l)/cellSize);
+            int b = (int) ((splineBounds[i].b-total.b)/cellSize), t = (int) ((splineBounds[i].t-total.b)/cellSize);
+            for (int y = b; y <= t; ++y) {
+                for (int x = l; x <= r; ++x) {
+                    if (pass)
+                        cellSplines[cellStarts[y*gridWidth+x]++] = i;
+                    else
+                        ++cellStarts[y*gridWidth+x+1];
+                }
+            }
+        }
+        if (!pass) {
+            for (int i = 0; i < gridWidth*gridHeight; ++i)
+                cellStarts[i+1] += cellStarts[i];
+            cellSplines.resize(cellStarts.back());
+        } else {
+            // Starts were advanced to the ends of cells by the second pass
+            for (int i = gridWidth*gridHeight; i > 0; --i)
+                cellStarts[i] = cellStarts[i-1];
+            cellStarts[0] = 0;
+        }
+    }
+
+    std::vector<int> lastVisitor(splineCount, -1);
+    std::vector<int> neighbors;
+    for (int i = 0; i < splineCount; ++i) {
+        int l = max((int) ((splineBounds[i].l-cutoffDistance-total.l)/cellSize), 0), r = min((int) ((splineBounds[i].r+cutoffDistance-total.l)/cellSize), gridWidth-1);
+        int b = max((int) ((splineBounds[i].b-cutoffDistance-total.b)/cellSize), 0), t = min((int) ((splineBounds[i].t+cutoffDistance-total.b)/cellSize), gridHeight-1);
+        neighbors.clear();
+        for (int y = b; y <= t; ++y) {
+            for (int x = l; x <= r; ++x) {
+                for (int k = cellStarts[y*gridWidth+x]; k < cellStarts[y*gridWidth+x+1]; ++k) {
+                    int j = cellSplines[k];
+                    if (j > i && lastVisitor[j] != i) {
+                        lastVisitor[j] = i;
+                        if (boundsDistance(splineBounds[i], splineBounds[j]) <= cutoffDistance)
+                            neighbors.push_back(j);
+                    }
+                }
+            }
+        }
+        std::sort(neighbors.begin(), neighbors.end());
+        for (std::vector<int>::const_iterator j = neighbors.begin(); j != neighbors.end(); ++j) {
+            SplinePair pair = { 0, i, *j };
+            pairs.push_back(pair);
+        }
+    }
 }
 
 void edgeColoringByDistance(Shape &shape, double angleThreshold, unsigned long long seed) {
@@ -475,49 +577,42 @@ void edgeColoringByDistance(Shape &shape, double angleThreshold, unsigned long l
     if (!splineCount)
         return;
 
-    std::vector<double> distanceMatrixStorage(splineCount*splineCount);
-    std::vector<double *> distanceMatrix(splineCount);
-    for (int i = 0; i < splineCount; ++i)
-        distanceMatrix[i] = &distanceMatrixStorage[i*splineCount];
-    const double *distanceMatrixBase = &distanceMatrixStorage[0];
-
+    // Only pairs of splines that are close relative to the typical spline size are considered
+    std::vector<Shape::Bounds> splineBounds(splineCount);
+    std::vector<double> splineSizes(splineCount);
     for (int i = 0; i < splineCount; ++i) {
-        distanceMatrix[i][i] = -1;
-        for (int j = i+1; j < splineCount; ++j) {
-            double dist = splineToSplineDistance(&edgeSegments[0], splineStarts[i], splineStarts[i+1], splineStarts[j], splineStarts[j+1], EDGE_DISTANCE_PRECISION);
-            distanceMatrix[i][j] = dist;
-            distanceMatrix[j][i] = dist;
-        }
+        Shape::Bounds &bounds = splineBounds[i];
+        bounds.l = DBL_MAX, bounds.b = DBL_MAX, bounds.r = -DBL_MAX, bounds.t = -DBL_MAX;
+        for (int j = splineStarts[i]; j < splineStarts[i+1]; ++j)
+            edgeSegments[j]->bound(bounds.l, bounds.b, bounds.r, bounds.t);
+        splineSizes[i] = Vector2(bounds.r-bounds.l, bounds.t-bounds.b).length();
     }
-
-    std::vector<const double *> graphEdgeDistances;
-    graphEdgeDistances.reserve(splineCount*(splineCount-1)/2);
-    for (int i = 0; i < splineCount; ++i)
-        for (int j = i+1; j < splineCount; ++j)
-            graphEdgeDistances.push_back(&distanceMatrix[i][j]);
-    int graphEdgeCount = (int) graphEdgeDistances.size();
-    if (!graphEdgeDistances.empty())
-        qsort(&graphEdgeDistances[0], graphEdgeDistances.size(), sizeof(const double *), &cmpDoublePtr);
-
-    std::vector<int> edgeMatrixStorage(splineCount*splineCount);
-    std::vector<int *> edgeMatrix(splineCount);
-    for (int i = 0; i < splineCount; ++i)
-        edgeMatrix[i] = &edgeMatrixStorage[i*splineCount];
-    int nextEdge = 0;
-    for (; nextEdge < graphEdgeCount && !*graphEdgeDistances[nextEdge]; ++nextEdge) {
-        int elem = (int) (graphEdgeDistances[nextEdge]-distanceMatrixBase);
-        int row = elem/splineCount;
-        int col = elem%splineCount;
-        edgeMatrix[row][col] = 1;
-        edgeMatrix[col][row] = 1;
+    std::nth_element(splineSizes.begin(), splineSizes.begin()+splineCount/2, splineSizes.end());
+    double cutoffDistance = EDGE_DISTANCE_CUTOFF_FACTOR*splineSizes[splineCount/2];
+
+    std::vector<SplinePair> graphEdges;
+    findNearbySplinePairs(graphEdges, splineBounds, cutoffDistance);
+    int graphEdgeCount = (int) graphEdges.size();
+#ifdef MSDFGEN_USE_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i = 0; i < graphEdgeCount; ++i) {
+        SplinePair &pair = graphEdges[i];
+        pair.distance = splineToSplineDistance(&edgeSegments[0], splineStarts[pair.a], splineStarts[pair.a+1], splineStarts[pair.b], splineStarts[pair.b+1], EDGE_DISTANCE_PRECISION);
     }
+    if (!graphEdges.empty())
+        qsort(&graphEdges[0], graphEdges.size(), sizeof(SplinePair), &cmpSplinePairs);
 
-    std::vector<int> coloring(2*splineCount);
-    colorSecondDegreeGraph(&coloring[0], &edgeMatrix[0], splineCount, seed);
-    for (; nextEdge < graphEdgeCount; ++nextEdge) {
-        int elem = (int) (graphEdgeDistances[nextEdge]-distanceMatrixBase);
-        tryAddEdge(&coloring[0], &edgeMatrix[0], splineCount, elem/splineCount, elem%splineCount, &coloring[splineCount]);
-    }
+    std::vector<std::vector<int> > adjacency(splineCount);
+    int nextEdge = 0;
+    for (; nextEdge < graphEdgeCount && !graphEdges[nextEdge].distance; ++nextEdge)
+        addAdjacency(&adjacency[0], graphEdges[nextEdge].a, graphEdges[nextEdge].b);
+
+    std::vector<int> coloring(splineCount);
+    std::vector<std::pair<int, int> > coloringChanges;
+    colorSecondDegreeGraph(&coloring[0], &adjacency[0], splineCount, seed);
+    for (; nextEdge < graphEdgeCount; ++nextEdge)
+        tryAddEdge(&coloring[0], &adjacency[0], graphEdges[nextEdge].a, graphEdges[nextEdge].b, coloringChanges);
 
     const EdgeColor colors[3] = { YELLOW, CYAN, MAGENTA };
     int spline = -1;
@@ -62,7 +62,7 @@ QuadraticSegment::QuadraticSegment(Point2 p0, Point2 p1, Point2 p2, EdgeColor ed
     p[2] = p2;
 }
 
-CubicSegment::CubicSegment(Point2 p0, Point2 p1, Point2 p2, Point2 p3, EdgeColor edgeColor) : EdgeSegment(edgeColor) {
+CubicSegment::CubicSegment(Point2 p0, Point2 p1, Point2 p2, Point2 p3, EdgeColor edgeColor) : EdgeSegment(edgeColor), searchStarts(MSDFGEN_CUBIC_SEARCH_STARTS), searchTolerance(0) {
     p[0] = p0;
     p[1] = p1;
     p[2] = p2;
@@ -78,7 +78,10 @@ QuadraticSegment *QuadraticSegment::clone() const {
 }
 
 CubicSegment *CubicSegment::clone() const {
-    return new CubicSegment(p[0], p[1], p[2], p[3], color);
+    CubicSegment *clone = new CubicSegment(p[0], p[1], p[2], p[3], color);
+    clone->searchStarts = searchStarts;
+    clone->searchTolerance = searchTolerance;
+    return clone;
 }
 
 int LinearSegment::type() const {
@@ -243,8 +246,8 @@ SignedDistance CubicSegment::signedDistance(Point2 origin, double &param) const
         }
     }
     // Iterative minimum distance search
-    for (int i = 0; i <= MSDFGEN_CUBIC_SEARCH_STARTS; ++i) {
-        double t = 1./MSDFGEN_CUBIC_SEARCH_STARTS*i;
+    for (int i = 0; i <= searchStarts; ++i) {
+        double t = 1./searchStarts*i;
         Vector2 qe = qa+3*t*ab+3*t*t*br+t*t*t*as;
         Vector2 d1 = 3*ab+6*t*br+3*t*t*as;
         Vector2 d2 = 6*br+6*t*as;
@@ -259,7 +262,7 @@ SignedDistance CubicSegment::signedDistance(Point2 origin, double &param) const
                     break;
                 d2 = 6*br+6*t*as;
                 improvedT = t-dotProduct(qe, d1)/(dotProduct(d1, d1)+dotProduct(qe, d2));
-            } while (improvedT > 0 && improvedT < 1);
+            } while (improvedT > 0 && improvedT < 1 && (improvedT-t)*(improvedT-t)*dotProduct(d1, d1) > searchTolerance*searchTolerance);
             double distance = qe.length();
             if (distance < fabs(minDistance)) {
                 minDistance = nonZeroSign(crossProduct(d1, qe))*distance;
@@ -526,6 +529,24 @@ void CubicSegment::splitInThirds(EdgeSegment *&part0, EdgeSegment *&part1, EdgeS
     part2 = new CubicSegment(point(2/3.), mix(mix(p[1], p[2], 2/3.), mix(p[2], p[3], 2/3.), 2/3.), p[2] == p[3] ? p[3] : mix(p[2], p[3], 2/3.), p[3], color);
 }
 
+void CubicSegment::setSearchPrecision(double tolerance) {
+    // Bound of the distance between the curve and its chord as in flattenShape
+    Vector2 d1 = p[1]-(1./3)*(2*p[0]+p[3]), d2 = p[2]-(1./3)*(p[0]+2*p[3]);
+    if (.75*max(d1.length(), d2.length()) <= tolerance)
+        searchStarts = 1;
+    else {
+        // The total turning of the control polygon bounds that of the curve, each additional quarter turn gets another starting point
+        Vector2 a = p[1]-p[0], b = p[2]-p[1], c = p[3]-p[2];
+        if (!a)
+            a = b;
+        if (!c)
+            c = b;
+        double turning = !b ? fabs(atan2(crossProduct(a, c), dotProduct(a, c))) : fabs(atan2(crossProduct(a, b), dotProduct(a, b)))+fabs(atan2(crossProduct(b, c), dotProduct(b, c)));
+        searchStarts = max(min(2+int(turning/(.5*M_PI)), MSDFGEN_CUBIC_SEARCH_STARTS), 1);
+    }
+    searchTolerance = tolerance;
+}
+
 EdgeSegment *QuadraticSegment::convertToCubic() const {
     return new CubicSegment(p[0], mix(p[0], p[1], 2/3.), mix(p[1], p[2], 1/3.), p[2], color);
 }
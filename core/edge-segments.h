@@ -124,6 +124,10 @@ public:
     };
 
     Point2 p[4];
+    /// The number of intervals whose boundaries serve as starting points of the iterative closest point search.
+    int searchStarts;
+    /// The distance along the curve below which the iterative closest point search may terminate early.
+    double searchTolerance;
 
     CubicSegment(Point2 p0, Point2 p1, Point2 p2, Point2 p3, EdgeColor edgeColor = WHITE);
     CubicSegment *clone() const;
@@ -141,6 +145,9 @@ public:
     void moveEndPoint(Point2 to);
     void splitInThirds(EdgeSegment *&part0, EdgeSegment *&part1, EdgeSegment *&part2) const;
 
+    /// Reduces the precision of the closest point search for curves that are flat or turn little relative to tolerance, which is the acceptable distance error.
+    void setSearchPrecision(double tolerance);
+
 };
 
 }
@@ -7,6 +7,22 @@ namespace msdfgen {
 
 #define DISTANCE_DELTA_FACTOR 1.001
 
+/// Passes the edge to the edge selector as its actual type, whose methods can then be called without virtual dispatch.
+template <class EdgeSelector>
+static void addEdgeOfType(EdgeSelector &edgeSelector, typename EdgeSelector::EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge) {
+    switch (edge->type()) {
+        case (int) LinearSegment::EDGE_TYPE:
+            edgeSelector.addEdge(cache, prevEdge, static_cast<const LinearSegment *>(edge), nextEdge);
+            break;
+        case (int) QuadraticSegment::EDGE_TYPE:
+            edgeSelector.addEdge(cache, prevEdge, static_cast<const QuadraticSegment *>(edge), nextEdge);
+            break;
+        case (int) CubicSegment::EDGE_TYPE:
+            edgeSelector.addEdge(cache, prevEdge, static_cast<const CubicSegment *>(edge), nextEdge);
+            break;
+    }
+}
+
 TrueDistanceSelector::EdgeCache::EdgeCache() : absDistance(0) { }
 
 void TrueDistanceSelector::reset(const Point2 &p) {
@@ -17,10 +33,15 @@ void TrueDistanceSelector::reset(const Point2 &p) {
 }
 
 void TrueDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge) {
+    addEdgeOfType(*this, cache, prevEdge, edge, nextEdge);
+}
+
+template <class EdgeType>
+void TrueDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeType *edge, const EdgeSegment *nextEdge) {
     double delta = DISTANCE_DELTA_FACTOR*(p-cache.point).length();
     if (cache.absDistance-delta <= fabs(minDistance.distance)) {
         double dummy;
-        SignedDistance distance = edge->signedDistance(p, dummy);
+        SignedDistance distance = edge->EdgeType::signedDistance(p, dummy);
         if (distance < minDistance)
             minDistance = distance;
         cache.point = p;
@@ -37,6 +58,72 @@ TrueDistanceSelector::DistanceType TrueDistanceSelector::distance() const {
     return minDistance.distance;
 }
 
+double TrueDistanceSelector::trueDistanceBound() const {
+    return fabs(minDistance.distance);
+}
+
+NearestEdgeSelector::NearestEdgeSelector() : nearEdge(NULL), nearEdgeParam(0) { }
+
+void NearestEdgeSelector::reset(const Point2 &p) {
+    double delta = DISTANCE_DELTA_FACTOR*(p-this->p).length();
+    minDistance.distance += nonZeroSign(minDistance.distance)*delta;
+    this->p = p;
+}
+
+void NearestEdgeSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge) {
+    addEdgeOfType(*this, cache, prevEdge, edge, nextEdge);
+}
+
+template <class EdgeType>
+void NearestEdgeSelector::addEdge(EdgeCache &cache, const EdgeSegment *, const EdgeType *edge, const EdgeSegment *) {
+    double delta = DISTANCE_DELTA_FACTOR*(p-cache.point).length();
+    if (cache.absDistance-delta <= fabs(minDistance.distance)) {
+        double param;
+        SignedDistance distance = edge->EdgeType::signedDistance(p, param);
+        if (distance < minDistance) {
+            minDistance = distance;
+            nearEdge = edge;
+            nearEdgeParam = param;
+        }
+        cache.point = p;
+        cache.absDistance = fabs(distance.distance);
+    }
+}
+
+void NearestEdgeSelector::merge(const NearestEdgeSelector &other) {
+    if (other.minDistance < minDistance) {
+        minDistance = other.minDistance;
+        nearEdge = other.nearEdge;
+        nearEdgeParam = other.nearEdgeParam;
+    }
+}
+
+NearestEdgeSelector::DistanceType NearestEdgeSelector::distance() const {
+    EdgeDistance distance;
+    distance.distance = minDistance.distance;
+    distance.edge = nearEdge;
+    distance.param = nearEdgeParam;
+    return distance;
+}
+
+double NearestEdgeSelector::trueDistanceBound() const {
+    return fabs(minDistance.distance);
+}
+
+GradientDistanceSelector::DistanceType GradientDistanceSelector::distance() const {
+    DistanceType distance;
+    distance.distance = minDistance.distance;
+    distance.gradient = Vector2();
+    if (nearEdge) {
+        // Distance is measured along the normal of the edge if its nearest point is in its interior, otherwise radially from the endpoint
+        if (nearEdgeParam > 0 && nearEdgeParam < 1)
+            distance.gradient = nearEdge->direction(nearEdgeParam).getOrthonormal(false);
+        else
+            distance.gradient = nonZeroSign(minDistance.distance)*(p-nearEdge->point(clamp(nearEdgeParam))).normalize(true);
+    }
+    return distance;
+}
+
 PerpendicularDistanceSelectorBase::EdgeCache::EdgeCache() : absDistance(0), aDomainDistance(0), bDomainDistance(0), aPerpendicularDistance(0), bPerpendicularDistance(0) { }
 
 bool PerpendicularDistanceSelectorBase::getPerpendicularDistance(double &distance, const Vector2 &ep, const Vector2 &edgeDir) {
@@ -120,6 +207,10 @@ SignedDistance PerpendicularDistanceSelectorBase::trueDistance() const {
     return minTrueDistance;
 }
 
+double PerpendicularDistanceSelectorBase::trueDistanceBound() const {
+    return fabs(minTrueDistance.distance);
+}
+
 void PerpendicularDistanceSelector::reset(const Point2 &p) {
     double delta = DISTANCE_DELTA_FACTOR*(p-this->p).length();
     PerpendicularDistanceSelectorBase::reset(delta);
@@ -127,17 +218,22 @@ void PerpendicularDistanceSelector::reset(const Point2 &p) {
 }
 
 void PerpendicularDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge) {
+    addEdgeOfType(*this, cache, prevEdge, edge, nextEdge);
+}
+
+template <class EdgeType>
+void PerpendicularDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeType *edge, const EdgeSegment *nextEdge) {
     if (isEdgeRelevant(cache, edge, p)) {
         double param;
-        SignedDistance distance = edge->signedDistance(p, param);
+        SignedDistance distance = edge->EdgeType::signedDistance(p, param);
         addEdgeTrueDistance(edge, distance, param);
         cache.point = p;
         cache.absDistance = fabs(distance.distance);
 
-        Vector2 ap = p-edge->point(0);
-        Vector2 bp = p-edge->point(1);
-        Vector2 aDir = edge->direction(0).normalize(true);
-        Vector2 bDir = edge->direction(1).normalize(true);
+        Vector2 ap = p-edge->EdgeType::point(0);
+        Vector2 bp = p-edge->EdgeType::point(1);
+        Vector2 aDir = edge->EdgeType::direction(0).normalize(true);
+        Vector2 bDir = edge->EdgeType::direction(1).normalize(true);
         Vector2 prevDir = prevEdge->direction(1).normalize(true);
         Vector2 nextDir = nextEdge->direction(0).normalize(true);
         double add = dotProduct(ap, (prevDir+aDir).normalize(true));
@@ -172,13 +268,18 @@ void MultiDistanceSelector::reset(const Point2 &p) {
 }
 
 void MultiDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge) {
+    addEdgeOfType(*this, cache, prevEdge, edge, nextEdge);
+}
+
+template <class EdgeType>
+void MultiDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeType *edge, const EdgeSegment *nextEdge) {
     if (
         (edge->color&RED && r.isEdgeRelevant(cache, edge, p)) ||
         (edge->color&GREEN && g.isEdgeRelevant(cache, edge, p)) ||
         (edge->color&BLUE && b.isEdgeRelevant(cache, edge, p))
     ) {
         double param;
-        SignedDistance distance = edge->signedDistance(p, param);
+        SignedDistance distance = edge->EdgeType::signedDistance(p, param);
         if (edge->color&RED)
             r.addEdgeTrueDistance(edge, distance, param);
         if (edge->color&GREEN)
@@ -188,10 +289,10 @@ void MultiDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdg
         cache.point = p;
         cache.absDistance = fabs(distance.distance);
 
-        Vector2 ap = p-edge->point(0);
-        Vector2 bp = p-edge->point(1);
-        Vector2 aDir = edge->direction(0).normalize(true);
-        Vector2 bDir = edge->direction(1).normalize(true);
+        Vector2 ap = p-edge->EdgeType::point(0);
+        Vector2 bp = p-edge->EdgeType::point(1);
+        Vector2 aDir = edge->EdgeType::direction(0).normalize(true);
+        Vector2 bDir = edge->EdgeType::direction(1).normalize(true);
         Vector2 prevDir = prevEdge->direction(1).normalize(true);
         Vector2 nextDir = nextEdge->direction(0).normalize(true);
         double add = dotProduct(ap, (prevDir+aDir).normalize(true));
@@ -249,6 +350,10 @@ SignedDistance MultiDistanceSelector::trueDistance() const {
     return distance;
 }
 
+double MultiDistanceSelector::trueDistanceBound() const {
+    return max(r.trueDistanceBound(), max(g.trueDistanceBound(), b.trueDistanceBound()));
+}
+
 MultiAndTrueDistanceSelector::DistanceType MultiAndTrueDistanceSelector::distance() const {
     MultiDistance multiDistance = MultiDistanceSelector::distance();
     MultiAndTrueDistance mtd;
@@ -259,4 +364,17 @@ MultiAndTrueDistanceSelector::DistanceType MultiAndTrueDistanceSelector::distanc
     return mtd;
 }
 
+template void TrueDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const LinearSegment *edge, const EdgeSegment *nextEdge);
+template void TrueDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const QuadraticSegment *edge, const EdgeSegment *nextEdge);
+template void TrueDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const CubicSegment *edge, const EdgeSegment *nextEdge);
+template void NearestEdgeSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const LinearSegment *edge, const EdgeSegment *nextEdge);
+template void NearestEdgeSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const QuadraticSegment *edge, const EdgeSegment *nextEdge);
+template void NearestEdgeSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const CubicSegment *edge, const EdgeSegment *nextEdge);
+template void PerpendicularDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const LinearSegment *edge, const EdgeSegment *nextEdge);
+template void PerpendicularDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const QuadraticSegment *edge, const EdgeSegment *nextEdge);
+template void PerpendicularDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const CubicSegment *edge, const EdgeSegment *nextEdge);
+template void MultiDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const LinearSegment *edge, const EdgeSegment *nextEdge);
+template void MultiDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const QuadraticSegment *edge, const EdgeSegment *nextEdge);
+template void MultiDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const CubicSegment *edge, const EdgeSegment *nextEdge);
+
 }
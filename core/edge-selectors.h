@@ -13,6 +13,17 @@ struct MultiDistance {
 struct MultiAndTrueDistance : MultiDistance {
     double a;
 };
+/// True distance together with the edge it is measured to and the parameter of the edge's nearest point.
+struct EdgeDistance {
+    double distance;
+    const EdgeSegment *edge;
+    double param;
+};
+/// True distance together with its gradient, the unit vector in which it increases the fastest.
+struct GradientDistance {
+    double distance;
+    Vector2 gradient;
+};
 
 /// Selects the nearest edge by its true distance.
 class TrueDistanceSelector {
@@ -29,8 +40,12 @@ public:
 
     void reset(const Point2 &p);
     void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    /// Equivalent to addEdge for an edge of the known type EdgeType (LinearSegment, QuadraticSegment, or CubicSegment), whose methods are called without virtual dispatch.
+    template <class EdgeType>
+    void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeType *edge, const EdgeSegment *nextEdge);
     void merge(const TrueDistanceSelector &other);
     DistanceType distance() const;
+    double trueDistanceBound() const;
 
 private:
     Point2 p;
@@ -38,6 +53,40 @@ private:
 
 };
 
+/// Selects the nearest edge by its true distance like TrueDistanceSelector, and also identifies it.
+class NearestEdgeSelector {
+
+public:
+    typedef EdgeDistance DistanceType;
+    typedef TrueDistanceSelector::EdgeCache EdgeCache;
+
+    NearestEdgeSelector();
+    void reset(const Point2 &p);
+    void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    template <class EdgeType>
+    void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeType *edge, const EdgeSegment *nextEdge);
+    void merge(const NearestEdgeSelector &other);
+    DistanceType distance() const;
+    double trueDistanceBound() const;
+
+protected:
+    Point2 p;
+    SignedDistance minDistance;
+    const EdgeSegment *nearEdge;
+    double nearEdgeParam;
+
+};
+
+/// Selects the nearest edge by its true distance like NearestEdgeSelector and also computes the distance's gradient.
+class GradientDistanceSelector : public NearestEdgeSelector {
+
+public:
+    typedef GradientDistance DistanceType;
+
+    DistanceType distance() const;
+
+};
+
 class PerpendicularDistanceSelectorBase {
 
 public:
@@ -60,6 +109,7 @@ public:
     void merge(const PerpendicularDistanceSelectorBase &other);
     double computeDistance(const Point2 &p) const;
     SignedDistance trueDistance() const;
+    double trueDistanceBound() const;
 
 private:
     SignedDistance minTrueDistance;
@@ -78,6 +128,8 @@ public:
 
     void reset(const Point2 &p);
     void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    template <class EdgeType>
+    void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeType *edge, const EdgeSegment *nextEdge);
     DistanceType distance() const;
 
 private:
@@ -94,9 +146,12 @@ public:
 
     void reset(const Point2 &p);
     void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    template <class EdgeType>
+    void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeType *edge, const EdgeSegment *nextEdge);
     void merge(const MultiDistanceSelector &other);
     DistanceType distance() const;
     SignedDistance trueDistance() const;
+    double trueDistanceBound() const;
 
 private:
     Point2 p;
@@ -50,8 +50,12 @@ struct ErrorCorrectionConfig {
 struct GeneratorConfig {
     /// Specifies whether to use the version of the algorithm that supports overlapping contours with the same winding. May be set to false to improve performance when no such contours are present.
     bool overlapSupport;
+    /// If overlap support is enabled, specifies whether to analyze the shape first and use the faster version of the algorithm anyway if it can be proven that no contours overlap.
+    bool overlapDetection;
+    /// The acceptable distance error in output pixels of the closest point search on cubic curves, which allows fewer iterations for small and flat curves. Zero means full precision.
+    double cubicSearchTolerance;
 
-    inline explicit GeneratorConfig(bool overlapSupport = true) : overlapSupport(overlapSupport) { }
+    inline explicit GeneratorConfig(bool overlapSupport = true, double cubicSearchTolerance = 0) : overlapSupport(overlapSupport), overlapDetection(false), cubicSearchTolerance(cubicSearchTolerance) { }
 };
 
 /// The configuration of the multi-channel distance field generator algorithm.
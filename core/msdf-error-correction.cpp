@@ -39,7 +39,7 @@ static void msdfErrorCorrectionInner(const BitmapSection<float, N> &sdf, const S
             ec.protectAll();
     }
     if (config.errorCorrection.distanceCheckMode == ErrorCorrectionConfig::ALWAYS_CHECK_DISTANCE || config.errorCorrection.distanceCheckMode == ErrorCorrectionConfig::CHECK_DISTANCE_AT_EDGE) {
-        if (config.overlapSupport)
+        if (config.overlapSupport && !(config.overlapDetection && shape.isOverlapFree()))
             ec.findErrors<OverlappingContourCombiner, N>(sdf, shape);
         else
             ec.findErrors<SimpleContourCombiner, N>(sdf, shape);
@@ -1,10 +1,22 @@
 
 #include "../msdfgen.h"
 
+#include <cfloat>
 #include <vector>
+#include <algorithm>
 #include "edge-selectors.h"
 #include "contour-combiners.h"
 #include "ShapeDistanceFinder.h"
+#include "viewport-culling.h"
+
+// Spacing of the adaptive generator's coarse grid in pixels
+#define ADAPTIVE_GRID_STEP 4
+// Margin of the adaptive generator's test that values do not change faster than distance
+#define ADAPTIVE_SLOPE_MARGIN 1.001
+// Maximum spacing in pixels of the points sampled along edges to mark the narrow band around them
+#define NARROW_BAND_SAMPLE_SPACING .25
+// Width and height of the tiles in which the narrow band generator's sweeps can proceed in parallel
+#define NARROW_BAND_SWEEP_TILE_SIZE 64
 
 namespace msdfgen {
 
@@ -49,90 +61,570 @@ public:
     }
 };
 
+template <>
+class DistancePixelConversion<EdgeDistance> {
+    DistanceMapping mapping;
+public:
+    typedef BitmapSection<float, 1> BitmapSectionType;
+    inline explicit DistancePixelConversion(DistanceMapping mapping) : mapping(mapping) { }
+    inline void operator()(float *pixels, const EdgeDistance &distance) const {
+        *pixels = float(mapping(distance.distance));
+    }
+};
+
+template <>
+class DistancePixelConversion<GradientDistance> {
+    DistanceMapping mapping;
+public:
+    typedef BitmapSection<float, 3> BitmapSectionType;
+    inline explicit DistancePixelConversion(DistanceMapping mapping) : mapping(mapping) { }
+    inline void operator()(float *pixels, const GradientDistance &distance) const {
+        pixels[0] = float(mapping(distance.distance));
+        pixels[1] = float(.5+.5*distance.gradient.x);
+        pixels[2] = float(.5+.5*distance.gradient.y);
+    }
+};
+
+/// Generates the distance field of each level, reusing each thread's distance finder for all of them.
 template <class ContourCombiner>
-void generateDistanceField(typename DistancePixelConversion<typename ContourCombiner::DistanceType>::BitmapSectionType output, const Shape &shape, const SDFTransformation &transformation) {
+void generateDistanceFields(const typename DistancePixelConversion<typename ContourCombiner::DistanceType>::BitmapSectionType *outputs, const Shape &shape, const SDFTransformation *transformations, int levelCount) {
+#ifdef MSDFGEN_USE_OPENMP
+    #pragma omp parallel
+#endif
+    {
+        ShapeDistanceFinder<ContourCombiner> distanceFinder(shape);
+        for (int level = 0; level < levelCount; ++level) {
+            typename DistancePixelConversion<typename ContourCombiner::DistanceType>::BitmapSectionType output = outputs[level];
+            const SDFTransformation &transformation = transformations[level];
+            DistancePixelConversion<typename ContourCombiner::DistanceType> distancePixelConversion(transformation.distanceMapping);
+            output.reorient(shape.getYAxisOrientation());
+            int xDirection = 1;
+#ifdef MSDFGEN_USE_OPENMP
+            #pragma omp for
+#endif
+            for (int y = 0; y < output.height; ++y) {
+                int x = xDirection < 0 ? output.width-1 : 0;
+                for (int col = 0; col < output.width; ++col) {
+                    Point2 p = transformation.unproject(Point2(x+.5, y+.5));
+                    typename ContourCombiner::DistanceType distance = distanceFinder.distance(p);
+                    distancePixelConversion(output(x, y), distance);
+                    x += xDirection;
+                }
+                xDirection = -xDirection;
+            }
+        }
+    }
+}
+
+template <int N>
+static int channelCount(const BitmapSection<float, N> &) {
+    return N;
+}
+
+/// Outputs the coordinates of the adaptive generator's coarse grid along a dimension of the given size, which are every ADAPTIVE_GRID_STEP-th pixel and the last pixel.
+static void coarseGridCoordinates(std::vector<int> &coords, int size) {
+    for (int i = 0; i < size; i += ADAPTIVE_GRID_STEP)
+        coords.push_back(i);
+    if (coords.back() != size-1)
+        coords.push_back(size-1);
+}
+
+/// Evaluates the distance field exactly on a coarse grid, in its cells where bilinear interpolation appears to deviate by more than threshold (in pixels), and where interpolated values lie within threshold of the edge, interpolates the rest.
+/// Whether a cell deviates is a heuristic judgement from its corners and center, so threshold does not bound the actual error. Returns the number of exact evaluations saved.
+template <class ContourCombiner>
+int generateDistanceFieldAdaptive(const typename DistancePixelConversion<typename ContourCombiner::DistanceType>::BitmapSectionType &outputSection, const Shape &shape, const SDFTransformation &transformation, double threshold) {
+    typename DistancePixelConversion<typename ContourCombiner::DistanceType>::BitmapSectionType output = outputSection;
+    if (output.width < 2 || output.height < 2) {
+        generateDistanceFields<ContourCombiner>(&output, shape, &transformation, 1);
+        return 0;
+    }
     DistancePixelConversion<typename ContourCombiner::DistanceType> distancePixelConversion(transformation.distanceMapping);
     output.reorient(shape.getYAxisOrientation());
+    int channels = channelCount(output);
+    std::vector<int> xs, ys;
+    coarseGridCoordinates(xs, output.width);
+    coarseGridCoordinates(ys, output.height);
+    int cols = int(xs.size()), rows = int(ys.size());
+    // Rate of change of output values per shape unit along the distance's gradient, and the dimensions of a pixel in shape units
+    double slope = fabs(transformation.distanceMapping(DistanceMapping::Delta(1)));
+    Vector2 pixelSize = transformation.unprojectVector(Vector2(1));
+    pixelSize.x = fabs(pixelSize.x), pixelSize.y = fabs(pixelSize.y);
+    double maxDeviation = slope*threshold*min(pixelSize.x, pixelSize.y);
+    // Output value of zero distance
+    double zeroValue = transformation.distanceMapping(0.);
+    int evaluations = cols*rows;
+    std::vector<char> refined((cols-1)*(rows-1));
 #ifdef MSDFGEN_USE_OPENMP
-    #pragma omp parallel
+    #pragma omp parallel reduction(+:evaluations)
 #endif
     {
         ShapeDistanceFinder<ContourCombiner> distanceFinder(shape);
-        int xDirection = 1;
 #ifdef MSDFGEN_USE_OPENMP
         #pragma omp for
 #endif
-        for (int y = 0; y < output.height; ++y) {
-            int x = xDirection < 0 ? output.width-1 : 0;
-            for (int col = 0; col < output.width; ++col) {
+        for (int j = 0; j < rows; ++j) {
+            for (int i = 0; i < cols; ++i)
+                distancePixelConversion(output(xs[i], ys[j]), distanceFinder.distance(transformation.unproject(Point2(xs[i]+.5, ys[j]+.5))));
+        }
+#ifdef MSDFGEN_USE_OPENMP
+        #pragma omp for schedule(dynamic)
+#endif
+        for (int j = 0; j < rows-1; ++j) {
+            for (int i = 0; i < cols-1; ++i) {
+                int x0 = xs[i], x1 = xs[i+1], y0 = ys[j], y1 = ys[j+1];
+                const float *c00 = output(x0, y0), *c10 = output(x1, y0), *c01 = output(x0, y1), *c11 = output(x1, y1);
+                double w = (x1-x0)*pixelSize.x, h = (y1-y0)*pixelSize.y;
+                // The center sample is stored in its pixel if it has one, so that it does not need to be reevaluated if the cell is refined
+                float centerSample[4];
+                float *center = centerSample;
+                if (!((x0+x1)&1 || (y0+y1)&1))
+                    center = output((x0+x1)>>1, (y0+y1)>>1);
+                distancePixelConversion(center, distanceFinder.distance(transformation.unproject(Point2(.5*(x0+x1)+.5, .5*(y0+y1)+.5))));
+                ++evaluations;
+                bool interpolate = true;
+                for (int c = 0; c < channels && interpolate; ++c) {
+                    double d00 = c00[c], d10 = c10[c], d01 = c01[c], d11 = c11[c];
+                    // Values can only change faster than distance across a discontinuity of pseudo-distance.
+                    // None of these tests is a guaranteed bound, since a feature smaller than the cell can fall between its samples
+                    double maxDx = ADAPTIVE_SLOPE_MARGIN*slope*w, maxDy = ADAPTIVE_SLOPE_MARGIN*slope*h;
+                    if (fabs(d10-d00) > maxDx || fabs(d11-d01) > maxDx || fabs(d01-d00) > maxDy || fabs(d11-d10) > maxDy)
+                        interpolate = false;
+                    // The gradient of distance has unit length, so a shorter average gradient indicates that it turns within the cell, e.g. across the medial axis
+                    Vector2 gradient(.5*(d10-d00+d11-d01)/w, .5*(d01-d00+d11-d10)/h);
+                    if ((slope-gradient.length())*.5*max(w, h) > maxDeviation)
+                        interpolate = false;
+                    // Distance is nearly linear within the cell unless it bends across a feature, which also shows in the twist of its corners
+                    if (fabs(d00-d10-d01+d11) > maxDeviation || fabs(center[c]-.25*(d00+d10+d01+d11)) > maxDeviation)
+                        interpolate = false;
+                }
+                refined[(cols-1)*j+i] = !interpolate;
+            }
+        }
+#ifdef MSDFGEN_USE_OPENMP
+        #pragma omp for schedule(dynamic)
+#endif
+        for (int j = 0; j < rows-1; ++j) {
+            // Each cell fills the pixels between its lower left corner and the next cells, and the last ones the top and right border
+            int y0 = ys[j], y1 = ys[j+1], yEnd = j == rows-2 ? y1 : y1-1;
+            for (int i = 0; i < cols-1; ++i) {
+                int x0 = xs[i], x1 = xs[i+1], xEnd = i == cols-2 ? x1 : x1-1;
+                const float *c00 = output(x0, y0), *c10 = output(x1, y0), *c01 = output(x0, y1), *c11 = output(x1, y1);
+                // Pixels on the border of two cells are only interpolated if neither of them is refined
+                bool interpolateInside = !refined[(cols-1)*j+i];
+                bool interpolateLeft = interpolateInside && !(i > 0 && refined[(cols-1)*j+i-1]);
+                bool interpolateBottom = interpolateInside && !(j > 0 && refined[(cols-1)*(j-1)+i]);
+                bool centerEvaluated = !(interpolateInside || (x0+x1)&1 || (y0+y1)&1);
+                for (int y = y0; y <= yEnd; ++y) {
+                    double v = double(y-y0)/(y1-y0);
+                    for (int x = x0; x <= xEnd; ++x) {
+                        if (((x == x0 || x == x1) && (y == y0 || y == y1)) || (centerEvaluated && x+x == x0+x1 && y+y == y0+y1))
+                            continue;
+                        float *pixel = output(x, y);
+                        bool interpolated = false;
+                        if (x == x0 ? interpolateLeft : y == y0 ? interpolateBottom : interpolateInside) {
+                            double u = double(x-x0)/(x1-x0);
+                            for (int c = 0; c < channels; ++c)
+                                pixel[c] = float(mix(mix(double(c00[c]), double(c10[c]), u), mix(double(c01[c]), double(c11[c]), u), v));
+                            // The sign of values this close to the edge may not match the exact ones, which would flip the pixel's channels in the scanline pass
+                            interpolated = fabs((channels >= 3 ? median(pixel[0], pixel[1], pixel[2]) : pixel[0])-zeroValue) > maxDeviation && (channels < 4 || fabs(pixel[3]-zeroValue) > maxDeviation);
+                        }
+                        if (!interpolated) {
+                            distancePixelConversion(pixel, distanceFinder.distance(transformation.unproject(Point2(x+.5, y+.5))));
+                            ++evaluations;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return output.width*output.height-evaluations;
+}
+
+/// Returns the nearest edge if the distance type identifies it, otherwise NULL.
+static const EdgeDistance *nearestEdge(const EdgeDistance &distance) {
+    return &distance;
+}
+
+template <typename DistanceType>
+static const EdgeDistance *nearestEdge(const DistanceType &) {
+    return NULL;
+}
+
+/// Nearest edge of a texel of the narrow band with its neighbors in the contour and its nearest point, which are propagated to the texels outside of the band.
+struct NarrowBandSeed {
+    Point2 point;
+    const EdgeSegment *prevEdge, *edge, *nextEdge;
+};
+
+/// Orders the seeds' edges by address so that they can be looked up.
+inline static bool lessEdge(const NarrowBandSeed &a, const NarrowBandSeed &b) {
+    return a.edge < b.edge;
+}
+
+/// Generates the distance field exactly within bandWidth pixels of the edges. Elsewhere, all channels are set to the true distance to the nearest edge of a texel of the band that is near, as found by sweeping over the bitmap in four directions.
+/// ContourCombiner computes the output values and EdgeCombiner the nearest edges, which may come from the same evaluation if it is the same.
+template <class ContourCombiner, class EdgeCombiner>
+void generateDistanceFieldNarrowBand(const typename DistancePixelConversion<typename ContourCombiner::DistanceType>::BitmapSectionType &outputSection, const Shape &shape, const SDFTransformation &transformation, double bandWidth) {
+    typename DistancePixelConversion<typename ContourCombiner::DistanceType>::BitmapSectionType output = outputSection;
+    DistancePixelConversion<typename ContourCombiner::DistanceType> distancePixelConversion(transformation.distanceMapping);
+    output.reorient(shape.getYAxisOrientation());
+    int w = output.width, h = output.height, channels = channelCount(output);
+
+    // Texels within bandWidth of an edge are within margin of one of its points sampled at most NARROW_BAND_SAMPLE_SPACING apart
+    std::vector<int> bandSeedIndices((size_t) w*h, -1);
+    std::vector<NarrowBandSeed> edgeNeighborhoods;
+    double margin = bandWidth+.5*NARROW_BAND_SAMPLE_SPACING;
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
+        for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+            NarrowBandSeed neighborhood;
+            neighborhood.prevEdge = edge == contour->edges.begin() ? contour->edges.back() : *(edge-1);
+            neighborhood.edge = *edge;
+            neighborhood.nextEdge = edge+1 == contour->edges.end() ? contour->edges.front() : *(edge+1);
+            edgeNeighborhoods.push_back(neighborhood);
+            // The edge's speed is bounded by its degree times the longest side of its control polygon
+            const Point2 *controlPoints = (*edge)->controlPoints();
+            int degree = (*edge)->type();
+            double maxSpeed = 0;
+            for (int i = 0; i < degree; ++i)
+                maxSpeed = max(maxSpeed, degree*transformation.projectVector(controlPoints[i+1]-controlPoints[i]).length());
+            int segments = max((int) ceil(maxSpeed/NARROW_BAND_SAMPLE_SPACING), 1);
+            for (int i = 0; i <= segments; ++i) {
+                Point2 q = transformation.project((*edge)->point(double(i)/segments));
+                int x0 = max((int) ceil(q.x-margin-.5), 0), x1 = min((int) floor(q.x+margin-.5), w-1);
+                int y0 = max((int) ceil(q.y-margin-.5), 0), y1 = min((int) floor(q.y+margin-.5), h-1);
+                for (int y = y0; y <= y1; ++y) {
+                    for (int x = x0; x <= x1; ++x)
+                        bandSeedIndices[(size_t) w*y+x] = 0;
+                }
+            }
+        }
+    }
+    int seedCount = 0;
+    for (std::vector<int>::iterator index = bandSeedIndices.begin(); index != bandSeedIndices.end(); ++index) {
+        if (*index >= 0)
+            *index = seedCount++;
+    }
+    if (!seedCount) {
+        generateDistanceFields<ContourCombiner>(&outputSection, shape, &transformation, 1);
+        return;
+    }
+    std::sort(edgeNeighborhoods.begin(), edgeNeighborhoods.end(), lessEdge);
+    std::vector<NarrowBandSeed> seeds(seedCount);
+    std::vector<int> seedIndices(bandSeedIndices);
+
+#ifdef MSDFGEN_USE_OPENMP
+    #pragma omp parallel
+#endif
+    {
+        ShapeDistanceFinder<ContourCombiner> distanceFinder(shape);
+        ShapeDistanceFinder<EdgeCombiner> edgeFinder(shape);
+#ifdef MSDFGEN_USE_OPENMP
+        #pragma omp for schedule(dynamic)
+#endif
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                int index = bandSeedIndices[(size_t) w*y+x];
+                if (index < 0)
+                    continue;
                 Point2 p = transformation.unproject(Point2(x+.5, y+.5));
                 typename ContourCombiner::DistanceType distance = distanceFinder.distance(p);
                 distancePixelConversion(output(x, y), distance);
-                x += xDirection;
+                EdgeDistance separateEdgeDistance;
+                const EdgeDistance *edgeDistance = nearestEdge(distance);
+                if (!edgeDistance) {
+                    separateEdgeDistance = edgeFinder.distance(p);
+                    edgeDistance = &separateEdgeDistance;
+                }
+                NarrowBandSeed &seed = seeds[index];
+                seed.edge = edgeDistance->edge;
+                seed = *std::lower_bound(edgeNeighborhoods.begin(), edgeNeighborhoods.end(), seed, lessEdge);
+                seed.point = seed.edge->point(clamp(edgeDistance->param));
+            }
+        }
+
+        // Sweeps in the four diagonal directions, each of which offers every texel the seeds of its four neighbors that have already been swept over.
+        // The rows are split into tiles, whose rows each start one texel earlier than the previous one, so that these neighbors lie in the same tile,
+        // the previous tile, or the three nearest tiles of the previous rows. Tiles are then swept in waves, each of which can be processed in parallel.
+        int tileCount = (w+2*NARROW_BAND_SWEEP_TILE_SIZE-2)/NARROW_BAND_SWEEP_TILE_SIZE;
+        int tileRowCount = (h+NARROW_BAND_SWEEP_TILE_SIZE-1)/NARROW_BAND_SWEEP_TILE_SIZE;
+        for (int pass = 0; pass < 4; ++pass) {
+            int dirX = pass&1 ? -1 : 1, dirY = pass&2 ? -1 : 1;
+            for (int wave = 0; wave < tileCount+2*(tileRowCount-1); ++wave) {
+                int firstTileRow = wave >= tileCount ? (wave-tileCount+2)/2 : 0, lastTileRow = min(wave/2, tileRowCount-1);
+#ifdef MSDFGEN_USE_OPENMP
+                #pragma omp for schedule(dynamic)
+#endif
+                for (int tileRow = firstTileRow; tileRow <= lastTileRow; ++tileRow) {
+                    int tile = wave-2*tileRow;
+                    for (int row = 0; row < NARROW_BAND_SWEEP_TILE_SIZE && tileRow*NARROW_BAND_SWEEP_TILE_SIZE+row < h; ++row) {
+                        int y = tileRow*NARROW_BAND_SWEEP_TILE_SIZE+row;
+                        if (dirY < 0)
+                            y = h-1-y;
+                        int begin = max(tile*NARROW_BAND_SWEEP_TILE_SIZE-row, 0), end = min((tile+1)*NARROW_BAND_SWEEP_TILE_SIZE-row, w);
+                        for (int column = begin; column < end; ++column) {
+                            int x = dirX < 0 ? w-1-column : column;
+                            size_t i = (size_t) w*y+x;
+                            if (bandSeedIndices[i] >= 0)
+                                continue;
+                            Point2 p = transformation.unproject(Point2(x+.5, y+.5));
+                            int best = seedIndices[i];
+                            double bestSquaredDistance = best >= 0 ? (seeds[best].point-p).squaredLength() : DBL_MAX;
+                            static const int neighbors[4][2] = { { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+                            for (int j = 0; j < 4; ++j) {
+                                int nx = x+dirX*neighbors[j][0], ny = y+dirY*neighbors[j][1];
+                                if (nx < 0 || nx >= w || ny < 0 || ny >= h)
+                                    continue;
+                                int candidate = seedIndices[(size_t) w*ny+nx];
+                                if (candidate >= 0 && candidate != best) {
+                                    double squaredDistance = (seeds[candidate].point-p).squaredLength();
+                                    if (squaredDistance < bestSquaredDistance) {
+                                        best = candidate;
+                                        bestSquaredDistance = squaredDistance;
+                                    }
+                                }
+                            }
+                            seedIndices[i] = best;
+                        }
+                    }
+                }
+            }
+        }
+
+#ifdef MSDFGEN_USE_OPENMP
+        #pragma omp for
+#endif
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                size_t i = (size_t) w*y+x;
+                if (bandSeedIndices[i] >= 0)
+                    continue;
+                const NarrowBandSeed &seed = seeds[seedIndices[i]];
+                Point2 p = transformation.unproject(Point2(x+.5, y+.5));
+                double param;
+                SignedDistance distance = seed.edge->signedDistance(p, param);
+                // Beyond an endpoint, the sign is only correct if the adjacent edge is compared too, like in TrueDistanceSelector
+                if (param < 0 || param > 1) {
+                    double dummy;
+                    SignedDistance adjacentDistance = (param < 0 ? seed.prevEdge : seed.nextEdge)->signedDistance(p, dummy);
+                    if (adjacentDistance < distance)
+                        distance = adjacentDistance;
+                }
+                float *pixel = output(x, y);
+                float value = float(transformation.distanceMapping(distance.distance));
+                for (int c = 0; c < channels; ++c)
+                    pixel[c] = value;
             }
-            xDirection = -xDirection;
         }
     }
 }
 
-void generateSDF(const BitmapSection<float, 1> &output, const Shape &shape, const SDFTransformation &transformation, const GeneratorConfig &config) {
-    if (config.overlapSupport)
-        generateDistanceField<OverlappingContourCombiner<TrueDistanceSelector> >(output, shape, transformation);
+/// Adapts the closest point search of each cubic edge of shape to the tolerance in shape units.
+static void setCubicSearchPrecision(Shape &shape, double tolerance) {
+    for (std::vector<Contour>::iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
+        for (std::vector<EdgeHolder>::iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+            if ((*edge)->type() == (int) CubicSegment::EDGE_TYPE)
+                static_cast<CubicSegment *>(&**edge)->setSearchPrecision(tolerance);
+        }
+    }
+}
+
+/// Determines whether the shape needs the version of the algorithm that supports overlapping contours.
+static bool needsOverlapSupport(const Shape &shape, const GeneratorConfig &config) {
+    return config.overlapSupport && !(config.overlapDetection && shape.isOverlapFree());
+}
+
+/// Determines whether culling preserves the output, which is only the case for true distance to the nearest edge of the whole shape.
+/// Culled edges could still be nearer by pseudo-distance, and the distance of a culled contour may matter to the overlapping contour combiner.
+static bool isCullable(const Shape &shape, const GeneratorConfig &config, bool trueDistance) {
+    return trueDistance && !needsOverlapSupport(shape, config);
+}
+
+/// If cull is set, culls the parts of shape which cannot affect the distance range of any output level, and applies the cubic search tolerance of the finest level.
+/// Returns either workingShape or the original shape if it is unchanged.
+template <int N>
+static const Shape &visibleShape(Shape &workingShape, const Shape &shape, const BitmapSection<float, N> *outputs, const SDFTransformation *transformations, int levelCount, const GeneratorConfig &config, bool cull) {
+    Shape::Bounds viewport = { };
+    double range = 0, tolerance = 0;
+    for (int level = 0; level < levelCount; ++level) {
+        const SDFTransformation &transformation = transformations[level];
+        Point2 a = transformation.unproject(Point2(0, 0));
+        Point2 b = transformation.unproject(Point2(outputs[level].width, outputs[level].height));
+        DistanceMapping inverseMapping = transformation.distanceMapping.inverse();
+        Vector2 levelTolerance = transformation.unprojectVector(Vector2(config.cubicSearchTolerance));
+        if (!level) {
+            viewport.l = min(a.x, b.x), viewport.b = min(a.y, b.y), viewport.r = max(a.x, b.x), viewport.t = max(a.y, b.y);
+            tolerance = min(fabs(levelTolerance.x), fabs(levelTolerance.y));
+        } else {
+            viewport.l = min(viewport.l, min(a.x, b.x)), viewport.b = min(viewport.b, min(a.y, b.y));
+            viewport.r = max(viewport.r, max(a.x, b.x)), viewport.t = max(viewport.t, max(a.y, b.y));
+            tolerance = min(tolerance, min(fabs(levelTolerance.x), fabs(levelTolerance.y)));
+        }
+        range = max(range, max(fabs(inverseMapping(0)), fabs(inverseMapping(1))));
+    }
+    bool culled = cull && cullShape(workingShape, shape, viewport, range);
+    if (config.cubicSearchTolerance > 0) {
+        if (!culled)
+            workingShape = shape;
+        setCubicSearchPrecision(workingShape, tolerance);
+        return workingShape;
+    }
+    return culled ? workingShape : shape;
+}
+
+
+void generateSDFLevels(const BitmapSection<float, 1> *outputs, const Shape &shape, const SDFTransformation *transformations, int levelCount, const GeneratorConfig &config) {
+    Shape workingShape;
+    const Shape &visible = visibleShape(workingShape, shape, outputs, transformations, levelCount, config, isCullable(shape, config, true));
+    if (needsOverlapSupport(shape, config))
+        generateDistanceFields<OverlappingContourCombiner<TrueDistanceSelector> >(outputs, visible, transformations, levelCount);
     else
-        generateDistanceField<SimpleContourCombiner<TrueDistanceSelector> >(output, shape, transformation);
+        generateDistanceFields<SimpleContourCombiner<TrueDistanceSelector> >(outputs, visible, transformations, levelCount);
 }
 
-void generatePSDF(const BitmapSection<float, 1> &output, const Shape &shape, const SDFTransformation &transformation, const GeneratorConfig &config) {
-    if (config.overlapSupport)
-        generateDistanceField<OverlappingContourCombiner<PerpendicularDistanceSelector> >(output, shape, transformation);
+void generatePSDFLevels(const BitmapSection<float, 1> *outputs, const Shape &shape, const SDFTransformation *transformations, int levelCount, const GeneratorConfig &config) {
+    Shape workingShape;
+    const Shape &visible = visibleShape(workingShape, shape, outputs, transformations, levelCount, config, isCullable(shape, config, false));
+    if (needsOverlapSupport(shape, config))
+        generateDistanceFields<OverlappingContourCombiner<PerpendicularDistanceSelector> >(outputs, visible, transformations, levelCount);
     else
-        generateDistanceField<SimpleContourCombiner<PerpendicularDistanceSelector> >(output, shape, transformation);
+        generateDistanceFields<SimpleContourCombiner<PerpendicularDistanceSelector> >(outputs, visible, transformations, levelCount);
 }
 
-void generateMSDF(const BitmapSection<float, 3> &output, const Shape &shape, const SDFTransformation &transformation, const MSDFGeneratorConfig &config) {
-    if (config.overlapSupport)
-        generateDistanceField<OverlappingContourCombiner<MultiDistanceSelector> >(output, shape, transformation);
+void generateMSDFLevels(const BitmapSection<float, 3> *outputs, const Shape &shape, const SDFTransformation *transformations, int levelCount, const MSDFGeneratorConfig &config) {
+    Shape workingShape;
+    const Shape &visible = visibleShape(workingShape, shape, outputs, transformations, levelCount, config, isCullable(shape, config, false));
+    MSDFGeneratorConfig resolvedConfig(config);
+    resolvedConfig.overlapSupport = needsOverlapSupport(shape, config);
+    resolvedConfig.overlapDetection = false;
+    if (resolvedConfig.overlapSupport)
+        generateDistanceFields<OverlappingContourCombiner<MultiDistanceSelector> >(outputs, visible, transformations, levelCount);
     else
-        generateDistanceField<SimpleContourCombiner<MultiDistanceSelector> >(output, shape, transformation);
-    msdfErrorCorrection(output, shape, transformation, config);
+        generateDistanceFields<SimpleContourCombiner<MultiDistanceSelector> >(outputs, visible, transformations, levelCount);
+    for (int level = 0; level < levelCount; ++level)
+        msdfErrorCorrection(outputs[level], visible, transformations[level], resolvedConfig);
 }
 
-void generateMTSDF(const BitmapSection<float, 4> &output, const Shape &shape, const SDFTransformation &transformation, const MSDFGeneratorConfig &config) {
-    if (config.overlapSupport)
-        generateDistanceField<OverlappingContourCombiner<MultiAndTrueDistanceSelector> >(output, shape, transformation);
+void generateMTSDFLevels(const BitmapSection<float, 4> *outputs, const Shape &shape, const SDFTransformation *transformations, int levelCount, const MSDFGeneratorConfig &config) {
+    Shape workingShape;
+    const Shape &visible = visibleShape(workingShape, shape, outputs, transformations, levelCount, config, isCullable(shape, config, false));
+    MSDFGeneratorConfig resolvedConfig(config);
+    resolvedConfig.overlapSupport = needsOverlapSupport(shape, config);
+    resolvedConfig.overlapDetection = false;
+    if (resolvedConfig.overlapSupport)
+        generateDistanceFields<OverlappingContourCombiner<MultiAndTrueDistanceSelector> >(outputs, visible, transformations, levelCount);
     else
-        generateDistanceField<SimpleContourCombiner<MultiAndTrueDistanceSelector> >(output, shape, transformation);
-    msdfErrorCorrection(output, shape, transformation, config);
+        generateDistanceFields<SimpleContourCombiner<MultiAndTrueDistanceSelector> >(outputs, visible, transformations, levelCount);
+    for (int level = 0; level < levelCount; ++level)
+        msdfErrorCorrection(outputs[level], visible, transformations[level], resolvedConfig);
 }
 
-void generateSDF(const BitmapSection<float, 1> &output, const Shape &shape, const Projection &projection, Range range, const GeneratorConfig &config) {
-    if (config.overlapSupport)
-        generateDistanceField<OverlappingContourCombiner<TrueDistanceSelector> >(output, shape, SDFTransformation(projection, range));
+void generateSDFWithGradient(const BitmapSection<float, 3> &output, const Shape &shape, const SDFTransformation &transformation, const GeneratorConfig &config) {
+    Shape workingShape;
+    const Shape &visible = visibleShape(workingShape, shape, &output, &transformation, 1, config, isCullable(shape, config, true));
+    if (needsOverlapSupport(shape, config))
+        generateDistanceFields<OverlappingContourCombiner<GradientDistanceSelector> >(&output, visible, &transformation, 1);
     else
-        generateDistanceField<SimpleContourCombiner<TrueDistanceSelector> >(output, shape, SDFTransformation(projection, range));
+        generateDistanceFields<SimpleContourCombiner<GradientDistanceSelector> >(&output, visible, &transformation, 1);
 }
 
-void generatePSDF(const BitmapSection<float, 1> &output, const Shape &shape, const Projection &projection, Range range, const GeneratorConfig &config) {
-    if (config.overlapSupport)
-        generateDistanceField<OverlappingContourCombiner<PerpendicularDistanceSelector> >(output, shape, SDFTransformation(projection, range));
+void generateSDFNarrowBand(const BitmapSection<float, 1> &output, const Shape &shape, const SDFTransformation &transformation, double bandWidth, const GeneratorConfig &config) {
+    Shape workingShape;
+    const Shape &visible = visibleShape(workingShape, shape, &output, &transformation, 1, config, isCullable(shape, config, true));
+    if (needsOverlapSupport(shape, config))
+        generateDistanceFieldNarrowBand<OverlappingContourCombiner<NearestEdgeSelector>, OverlappingContourCombiner<NearestEdgeSelector> >(output, visible, transformation, bandWidth);
     else
-        generateDistanceField<SimpleContourCombiner<PerpendicularDistanceSelector> >(output, shape, SDFTransformation(projection, range));
+        generateDistanceFieldNarrowBand<SimpleContourCombiner<NearestEdgeSelector>, SimpleContourCombiner<NearestEdgeSelector> >(output, visible, transformation, bandWidth);
 }
 
-void generateMSDF(const BitmapSection<float, 3> &output, const Shape &shape, const Projection &projection, Range range, const MSDFGeneratorConfig &config) {
-    if (config.overlapSupport)
-        generateDistanceField<OverlappingContourCombiner<MultiDistanceSelector> >(output, shape, SDFTransformation(projection, range));
+void generateMTSDFNarrowBand(const BitmapSection<float, 4> &output, const Shape &shape, const SDFTransformation &transformation, double bandWidth, const MSDFGeneratorConfig &config) {
+    Shape workingShape;
+    const Shape &visible = visibleShape(workingShape, shape, &output, &transformation, 1, config, isCullable(shape, config, false));
+    MSDFGeneratorConfig resolvedConfig(config);
+    resolvedConfig.overlapSupport = needsOverlapSupport(shape, config);
+    resolvedConfig.overlapDetection = false;
+    if (resolvedConfig.overlapSupport)
+        generateDistanceFieldNarrowBand<OverlappingContourCombiner<MultiAndTrueDistanceSelector>, OverlappingContourCombiner<NearestEdgeSelector> >(output, visible, transformation, bandWidth);
     else
-        generateDistanceField<SimpleContourCombiner<MultiDistanceSelector> >(output, shape, SDFTransformation(projection, range));
-    msdfErrorCorrection(output, shape, SDFTransformation(projection, range), config);
+        generateDistanceFieldNarrowBand<SimpleContourCombiner<MultiAndTrueDistanceSelector>, SimpleContourCombiner<NearestEdgeSelector> >(output, visible, transformation, bandWidth);
+    msdfErrorCorrection(output, visible, transformation, resolvedConfig);
 }
 
-void generateMTSDF(const BitmapSection<float, 4> &output, const Shape &shape, const Projection &projection, Range range, const MSDFGeneratorConfig &config) {
-    if (config.overlapSupport)
-        generateDistanceField<OverlappingContourCombiner<MultiAndTrueDistanceSelector> >(output, shape, SDFTransformation(projection, range));
+int generateSDFAdaptive(const BitmapSection<float, 1> &output, const Shape &shape, const SDFTransformation &transformation, double threshold, const GeneratorConfig &config) {
+    Shape workingShape;
+    const Shape &visible = visibleShape(workingShape, shape, &output, &transformation, 1, config, isCullable(shape, config, true));
+    if (needsOverlapSupport(shape, config))
+        return generateDistanceFieldAdaptive<OverlappingContourCombiner<TrueDistanceSelector> >(output, visible, transformation, threshold);
+    return generateDistanceFieldAdaptive<SimpleContourCombiner<TrueDistanceSelector> >(output, visible, transformation, threshold);
+}
+
+int generatePSDFAdaptive(const BitmapSection<float, 1> &output, const Shape &shape, const SDFTransformation &transformation, double threshold, const GeneratorConfig &config) {
+    Shape workingShape;
+    const Shape &visible = visibleShape(workingShape, shape, &output, &transformation, 1, config, isCullable(shape, config, false));
+    if (needsOverlapSupport(shape, config))
+        return generateDistanceFieldAdaptive<OverlappingContourCombiner<PerpendicularDistanceSelector> >(output, visible, transformation, threshold);
+    return generateDistanceFieldAdaptive<SimpleContourCombiner<PerpendicularDistanceSelector> >(output, visible, transformation, threshold);
+}
+
+int generateMSDFAdaptive(const BitmapSection<float, 3> &output, const Shape &shape, const SDFTransformation &transformation, double threshold, const MSDFGeneratorConfig &config) {
+    Shape workingShape;
+    const Shape &visible = visibleShape(workingShape, shape, &output, &transformation, 1, config, isCullable(shape, config, false));
+    MSDFGeneratorConfig resolvedConfig(config);
+    resolvedConfig.overlapSupport = needsOverlapSupport(shape, config);
+    resolvedConfig.overlapDetection = false;
+    int saved;
+    if (resolvedConfig.overlapSupport)
+        saved = generateDistanceFieldAdaptive<OverlappingContourCombiner<MultiDistanceSelector> >(output, visible, transformation, threshold);
+    else
+        saved = generateDistanceFieldAdaptive<SimpleContourCombiner<MultiDistanceSelector> >(output, visible, transformation, threshold);
+    msdfErrorCorrection(output, visible, transformation, resolvedConfig);
+    return saved;
+}
+
+int generateMTSDFAdaptive(const BitmapSection<float, 4> &output, const Shape &shape, const SDFTransformation &transformation, double threshold, const MSDFGeneratorConfig &config) {
+    Shape workingShape;
+    const Shape &visible = visibleShape(workingShape, shape, &output, &transformation, 1, config, isCullable(shape, config, false));
+    MSDFGeneratorConfig resolvedConfig(config);
+    resolvedConfig.overlapSupport = needsOverlapSupport(shape, config);
+    resolvedConfig.overlapDetection = false;
+    int saved;
+    if (resolvedConfig.overlapSupport)
+        saved = generateDistanceFieldAdaptive<OverlappingContourCombiner<MultiAndTrueDistanceSelector> >(output, visible, transformation, threshold);
     else
-        generateDistanceField<SimpleContourCombiner<MultiAndTrueDistanceSelector> >(output, shape, SDFTransformation(projection, range));
-    msdfErrorCorrection(output, shape, SDFTransformation(projection, range), config);
+        saved = generateDistanceFieldAdaptive<SimpleContourCombiner<MultiAndTrueDistanceSelector> >(output, visible, transformation, threshold);
+    msdfErrorCorrection(output, visible, transformation, resolvedConfig);
+    return saved;
+}
+
+void generateSDF(const BitmapSection<float, 1> &output, const Shape &shape, const SDFTransformation &transformation, const GeneratorConfig &config) {
+    generateSDFLevels(&output, shape, &transformation, 1, config);
+}
+
+void generatePSDF(const BitmapSection<float, 1> &output, const Shape &shape, const SDFTransformation &transformation, const GeneratorConfig &config) {
+    generatePSDFLevels(&output, shape, &transformation, 1, config);
+}
+
+void generateMSDF(const BitmapSection<float, 3> &output, const Shape &shape, const SDFTransformation &transformation, const MSDFGeneratorConfig &config) {
+    generateMSDFLevels(&output, shape, &transformation, 1, config);
+}
+
+void generateMTSDF(const BitmapSection<float, 4> &output, const Shape &shape, const SDFTransformation &transformation, const MSDFGeneratorConfig &config) {
+    generateMTSDFLevels(&output, shape, &transformation, 1, config);
+}
+
+void generateSDF(const BitmapSection<float, 1> &output, const Shape &shape, const Projection &projection, Range range, const GeneratorConfig &config) {
+    generateSDF(output, shape, SDFTransformation(projection, range), config);
+}
+
+void generatePSDF(const BitmapSection<float, 1> &output, const Shape &shape, const Projection &projection, Range range, const GeneratorConfig &config) {
+    generatePSDF(output, shape, SDFTransformation(projection, range), config);
+}
+
+void generateMSDF(const BitmapSection<float, 3> &output, const Shape &shape, const Projection &projection, Range range, const MSDFGeneratorConfig &config) {
+    generateMSDF(output, shape, SDFTransformation(projection, range), config);
+}
+
+void generateMTSDF(const BitmapSection<float, 4> &output, const Shape &shape, const Projection &projection, Range range, const MSDFGeneratorConfig &config) {
+    generateMTSDF(output, shape, SDFTransformation(projection, range), config);
 }
 
 // Legacy API
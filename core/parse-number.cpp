@@ -0,0 +1,79 @@
+
+#include "parse-number.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace msdfgen {
+
+static const double POWERS_OF_10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool parseNumber(double &output, const char *&str, const char *end) {
+    const char *c = str;
+    bool negative = false;
+    if (c < end && (*c == '+' || *c == '-'))
+        negative = *c++ == '-';
+    // Mantissa is accumulated exactly as long as it has at most 15 significant digits
+    double mantissa = 0;
+    int significantDigits = 0, digits = 0, exponent = 0;
+    bool exact = true;
+    for (; c < end && isDigit(*c); ++c, ++digits) {
+        if (significantDigits < 15) {
+            mantissa = 10*mantissa+(*c-'0');
+            significantDigits += mantissa != 0;
+        } else {
+            exact &= *c == '0';
+            ++exponent;
+        }
+    }
+    if (c < end && *c == '.') {
+        for (++c; c < end && isDigit(*c); ++c, ++digits) {
+            if (significantDigits < 15) {
+                mantissa = 10*mantissa+(*c-'0');
+                significantDigits += mantissa != 0;
+                --exponent;
+            } else
+                exact &= *c == '0';
+        }
+    }
+    if (!digits)
+        return false;
+    if (c < end && (*c == 'e' || *c == 'E')) {
+        const char *e = c+1;
+        bool negativeExponent = false;
+        if (e < end && (*e == '+' || *e == '-'))
+            negativeExponent = *e++ == '-';
+        if (e < end && isDigit(*e)) {
+            int explicitExponent = 0;
+            for (; e < end && isDigit(*e); ++e) {
+                if (explicitExponent < 100000)
+                    explicitExponent = 10*explicitExponent+(*e-'0');
+            }
+            exponent += negativeExponent ? -explicitExponent : explicitExponent;
+            c = e;
+        }
+    }
+    if (exact && exponent >= -22 && exponent <= 22) {
+        // Both operands are exact, so the result is correctly rounded
+        double value = exponent < 0 ? mantissa/POWERS_OF_10[-exponent] : mantissa*POWERS_OF_10[exponent];
+        output = negative ? -value : value;
+    } else {
+        // Fall back to strtod, which requires a null-terminated string
+        char buffer[64];
+        if ((size_t) (c-str) < sizeof(buffer)) {
+            memcpy(buffer, str, c-str);
+            buffer[c-str] = '\0';
+            output = strtod(buffer, NULL);
+        } else
+            output = strtod(std::string(str, c).c_str(), NULL);
+    }
+    str = c;
+    return true;
+}
+
+}
@@ -0,0 +1,12 @@
+
+#pragma once
+
+#include "base.h"
+
+namespace msdfgen {
+
+/// Parses a decimal floating-point number of the form [+-]digits[.digits][(e|E)[+-]digits] between str and end (doesn't have to be null-terminated).
+/// On success, advances str past the number and returns true.
+bool parseNumber(double &output, const char *&str, const char *end);
+
+}
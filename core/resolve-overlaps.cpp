@@ -0,0 +1,939 @@
+
+#include "resolve-overlaps.h"
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "arithmetics.hpp"
+#include "equation-solver.h"
+
+// Distance relative to the size of the shape below which two points are considered coincident
+#define OVERLAP_TOLERANCE 1e-9
+// Maximum number of subdivision steps when searching for intersections of a pair of curves
+#define CURVE_INTERSECTION_MAX_STEPS 65536
+// Number of Newton iterations refining each intersection
+#define CURVE_INTERSECTION_REFINE_STEPS 4
+// Number of bisection steps when solving for the parameter of a point on a monotonic curve
+#define BISECTION_STEPS 52
+
+namespace msdfgen {
+
+/// A portion of an edge segment between two parameter values, which is monotonic in both axes.
+struct EdgeSpan {
+    int edge;
+    double t0, t1;
+    int degree;
+    Point2 p[4];
+    double xMin, yMin, xMax, yMax;
+    int v0, v1;
+    int group;
+};
+
+struct CurveIntersection {
+    double a, b;
+    Point2 point;
+};
+
+/// A point where an edge is to be split, which is snapped to an intersection point if set.
+struct EdgeSplit {
+    double param;
+    int point;
+};
+
+static double coordinate(Point2 p, int axis) {
+    return axis ? p.y : p.x;
+}
+
+static int edgeDegree(const EdgeSegment *edge) {
+    switch (edge->type()) {
+        case (int) LinearSegment::EDGE_TYPE:
+            return 1;
+        case (int) QuadraticSegment::EDGE_TYPE:
+            return 2;
+        case (int) CubicSegment::EDGE_TYPE:
+            return 3;
+    }
+    return 0;
+}
+
+static EdgeSegment *createSegment(const Point2 *p, int degree) {
+    switch (degree) {
+        case 1:
+            return EdgeSegment::create(p[0], p[1]);
+        case 2:
+            return EdgeSegment::create(p[0], p[1], p[2]);
+        case 3:
+            return EdgeSegment::create(p[0], p[1], p[2], p[3]);
+    }
+    return NULL;
+}
+
+static Point2 bezierPoint(const Point2 *p, int degree, double t) {
+    Point2 q[4];
+    for (int i = 0; i <= degree; ++i)
+        q[i] = p[i];
+    for (int k = 1; k <= degree; ++k)
+        for (int i = 0; i <= degree-k; ++i)
+            q[i] = mix(q[i], q[i+1], t);
+    return q[0];
+}
+
+/// Splits a Bezier curve at parameter t using de Casteljau's algorithm.
+static void splitBezier(Point2 *left, Point2 *right, const Point2 *p, int degree, double t) {
+    Point2 q[4];
+    for (int i = 0; i <= degree; ++i)
+        q[i] = p[i];
+    left[0] = q[0];
+    right[degree] = q[degree];
+    for (int k = 1; k <= degree; ++k) {
+        for (int i = 0; i <= degree-k; ++i)
+            q[i] = mix(q[i], q[i+1], t);
+        left[k] = q[0];
+        right[degree-k] = q[degree-k];
+    }
+}
+
+/// Computes the control points of the portion of a Bezier curve between parameters t0 and t1.
+static void extractBezier(Point2 *output, const Point2 *p, int degree, double t0, double t1) {
+    Point2 head[4], tail[4];
+    const Point2 *q = p;
+    if (t1 < 1) {
+        splitBezier(head, tail, p, degree, t1);
+        q = head;
+    }
+    if (t0 > 0)
+        splitBezier(tail, output, q, degree, t0/t1);
+    else {
+        for (int i = 0; i <= degree; ++i)
+            output[i] = q[i];
+    }
+}
+
+/// Outputs the parameters where the curve reaches a local extreme in either axis.
+static int extremeParams(double *output, const Point2 *p, int degree) {
+    int count = 0;
+    for (int axis = 0; axis < 2; ++axis) {
+        double c0 = coordinate(p[0], axis), c1 = coordinate(p[1], axis);
+        if (degree == 2) {
+            double c2 = coordinate(p[2], axis);
+            double d = c0-2*c1+c2;
+            if (d) {
+                double t = (c0-c1)/d;
+                if (t > 0 && t < 1)
+                    output[count++] = t;
+            }
+        } else if (degree == 3) {
+            double c2 = coordinate(p[2], axis), c3 = coordinate(p[3], axis);
+            double t[2];
+            int solutions = solveQuadratic(t, -c0+3*c1-3*c2+c3, 2*(c0-2*c1+c2), c1-c0);
+            for (int i = 0; i < solutions; ++i)
+                if (t[i] > 0 && t[i] < 1)
+                    output[count++] = t[i];
+        }
+    }
+    return count;
+}
+
+static void boundSpan(EdgeSpan &span) {
+    span.xMin = span.xMax = span.p[0].x;
+    span.yMin = span.yMax = span.p[0].y;
+    for (int i = 1; i <= span.degree; ++i) {
+        span.xMin = min(span.xMin, span.p[i].x);
+        span.yMin = min(span.yMin, span.p[i].y);
+        span.xMax = max(span.xMax, span.p[i].x);
+        span.yMax = max(span.yMax, span.p[i].y);
+    }
+}
+
+static EdgeSpan makeSpan(const EdgeSegment *edge, int edgeIndex, double t0, double t1) {
+    EdgeSpan span;
+    span.edge = edgeIndex;
+    span.t0 = t0;
+    span.t1 = t1;
+    span.degree = edgeDegree(edge);
+    extractBezier(span.p, edge->controlPoints(), span.degree, t0, t1);
+    boundSpan(span);
+    span.v0 = span.v1 = -1;
+    span.group = -1;
+    return span;
+}
+
+static bool isFlat(const Point2 *p, int degree, double tolerance) {
+    Vector2 chord = p[degree]-p[0];
+    double chordLength = chord.length();
+    for (int i = 1; i < degree; ++i) {
+        if (chordLength > tolerance) {
+            if (fabs(crossProduct(p[i]-p[0], chord)) > tolerance*chordLength)
+                return false;
+        } else if ((p[i]-p[0]).length() > tolerance)
+            return false;
+    }
+    return true;
+}
+
+/// Projects point onto line segment l0-l1 and outputs its parameter if it lies on the segment within tolerance.
+static bool projectOntoLine(double &param, Point2 point, Point2 l0, Point2 l1, double tolerance) {
+    Vector2 dir = l1-l0;
+    double length = dir.length();
+    if (length <= tolerance) {
+        param = .5;
+        return (point-l0).length() <= tolerance;
+    }
+    param = dotProduct(point-l0, dir)/(length*length);
+    double paramTolerance = tolerance/length;
+    if (param < -paramTolerance || param > 1+paramTolerance || fabs(crossProduct(point-l0, dir)) > tolerance*length)
+        return false;
+    param = clamp(param);
+    return true;
+}
+
+static void intersectLines(std::vector<CurveIntersection> &output, Point2 a0, Point2 a1, double aT0, double aT1, Point2 b0, Point2 b1, double bT0, double bT1, double tolerance) {
+    Vector2 aDir = a1-a0, bDir = b1-b0;
+    double aLength = aDir.length(), bLength = bDir.length();
+    double cross = crossProduct(aDir, bDir);
+    CurveIntersection intersection;
+    if (fabs(cross) > tolerance*max(aLength, bLength)) {
+        double s = crossProduct(b0-a0, bDir)/cross;
+        double u = crossProduct(b0-a0, aDir)/cross;
+        double sTolerance = tolerance/aLength, uTolerance = tolerance/bLength;
+        if (s >= -sTolerance && s <= 1+sTolerance && u >= -uTolerance && u <= 1+uTolerance) {
+            intersection.a = mix(aT0, aT1, clamp(s));
+            intersection.b = mix(bT0, bT1, clamp(u));
+            output.push_back(intersection);
+        }
+    } else {
+        // Parallel lines may overlap, in which case the endpoints of one that lie on the other are their intersections
+        double param;
+        if (projectOntoLine(param, b0, a0, a1, tolerance)) {
+            intersection.a = mix(aT0, aT1, param);
+            intersection.b = bT0;
+            output.push_back(intersection);
+        }
+        if (projectOntoLine(param, b1, a0, a1, tolerance)) {
+            intersection.a = mix(aT0, aT1, param);
+            intersection.b = bT1;
+            output.push_back(intersection);
+        }
+        if (projectOntoLine(param, a0, b0, b1, tolerance)) {
+            intersection.a = aT0;
+            intersection.b = mix(bT0, bT1, param);
+            output.push_back(intersection);
+        }
+        if (projectOntoLine(param, a1, b0, b1, tolerance)) {
+            intersection.a = aT1;
+            intersection.b = mix(bT0, bT1, param);
+            output.push_back(intersection);
+        }
+    }
+}
+
+/// Finds the parameter where the projection of a flat curve onto its chord reaches the specified proportion of its length.
+static double chordParam(const Point2 *p, int degree, double proportion) {
+    if (degree == 1 || proportion <= 0 || proportion >= 1)
+        return proportion;
+    Vector2 chord = p[degree]-p[0];
+    double target = proportion*dotProduct(chord, chord);
+    double lo = 0, hi = 1;
+    for (int i = 0; i < BISECTION_STEPS; ++i) {
+        double mid = .5*(lo+hi);
+        if (dotProduct(bezierPoint(p, degree, mid)-p[0], chord) < target)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return .5*(lo+hi);
+}
+
+static void boundPoints(const Point2 *p, int degree, double &xMin, double &yMin, double &xMax, double &yMax) {
+    xMin = xMax = p[0].x;
+    yMin = yMax = p[0].y;
+    for (int i = 1; i <= degree; ++i) {
+        xMin = min(xMin, p[i].x);
+        yMin = min(yMin, p[i].y);
+        xMax = max(xMax, p[i].x);
+        yMax = max(yMax, p[i].y);
+    }
+}
+
+/// Checks if curve b lies entirely outside the band around the chord of curve a which contains curve a.
+static bool separatedByFatLine(const Point2 *a, int aDegree, const Point2 *b, int bDegree, double tolerance) {
+    Vector2 chord = a[aDegree]-a[0];
+    double chordLength = chord.length();
+    if (chordLength <= tolerance)
+        return false;
+    double aMin = 0, aMax = 0;
+    for (int i = 1; i < aDegree; ++i) {
+        double d = crossProduct(a[i]-a[0], chord)/chordLength;
+        aMin = min(aMin, d);
+        aMax = max(aMax, d);
+    }
+    double bMin = crossProduct(b[0]-a[0], chord)/chordLength, bMax = bMin;
+    for (int i = 1; i <= bDegree; ++i) {
+        double d = crossProduct(b[i]-a[0], chord)/chordLength;
+        bMin = min(bMin, d);
+        bMax = max(bMax, d);
+    }
+    return bMax+tolerance < aMin || aMax+tolerance < bMin;
+}
+
+/// Finds the intersections of two curves by recursive subdivision until they are flat enough to be intersected as lines. Returns false if the search had to be cut short.
+static bool intersectCurves(std::vector<CurveIntersection> &output, const Point2 *a, int aDegree, double aT0, double aT1, const Point2 *b, int bDegree, double bT0, double bT1, double tolerance, int &steps) {
+    if (--steps < 0)
+        return false;
+    double aXMin, aYMin, aXMax, aYMax, bXMin, bYMin, bXMax, bYMax;
+    boundPoints(a, aDegree, aXMin, aYMin, aXMax, aYMax);
+    boundPoints(b, bDegree, bXMin, bYMin, bXMax, bYMax);
+    if (aXMax+tolerance < bXMin || bXMax+tolerance < aXMin || aYMax+tolerance < bYMin || bYMax+tolerance < aYMin)
+        return true;
+    if (separatedByFatLine(a, aDegree, b, bDegree, tolerance) || separatedByFatLine(b, bDegree, a, aDegree, tolerance))
+        return true;
+    bool aFlat = isFlat(a, aDegree, tolerance);
+    bool bFlat = isFlat(b, bDegree, tolerance);
+    if (aFlat && bFlat) {
+        size_t first = output.size();
+        intersectLines(output, a[0], a[aDegree], 0, 1, b[0], b[bDegree], 0, 1, tolerance);
+        for (size_t i = first; i < output.size(); ++i) {
+            output[i].a = mix(aT0, aT1, chordParam(a, aDegree, output[i].a));
+            output[i].b = mix(bT0, bT1, chordParam(b, bDegree, output[i].b));
+        }
+        return true;
+    }
+    Point2 left[4], right[4];
+    if (!aFlat && (bFlat || max(aXMax-aXMin, aYMax-aYMin) >= max(bXMax-bXMin, bYMax-bYMin))) {
+        double aTMid = .5*(aT0+aT1);
+        splitBezier(left, right, a, aDegree, .5);
+        return (
+            intersectCurves(output, left, aDegree, aT0, aTMid, b, bDegree, bT0, bT1, tolerance, steps) &&
+            intersectCurves(output, right, aDegree, aTMid, aT1, b, bDegree, bT0, bT1, tolerance, steps)
+        );
+    } else {
+        double bTMid = .5*(bT0+bT1);
+        splitBezier(left, right, b, bDegree, .5);
+        return (
+            intersectCurves(output, a, aDegree, aT0, aT1, left, bDegree, bT0, bTMid, tolerance, steps) &&
+            intersectCurves(output, a, aDegree, aT0, aT1, right, bDegree, bTMid, bT1, tolerance, steps)
+        );
+    }
+}
+
+/// Finds where the endpoints of span a lie on span b.
+static void projectEndpoints(std::vector<CurveIntersection> &output, const EdgeSpan &a, const EdgeSpan &b, bool swap, double tolerance) {
+    EdgeSegment *segment = createSegment(b.p, b.degree);
+    for (int i = 0; i < 2; ++i) {
+        double param;
+        SignedDistance distance = segment->signedDistance(i ? a.p[a.degree] : a.p[0], param);
+        if (fabs(distance.distance) <= tolerance && param >= 0 && param <= 1) {
+            CurveIntersection intersection;
+            double aParam = i ? a.t1 : a.t0, bParam = mix(b.t0, b.t1, param);
+            intersection.a = swap ? bParam : aParam;
+            intersection.b = swap ? aParam : bParam;
+            intersection.point = i ? a.p[a.degree] : a.p[0];
+            output.push_back(intersection);
+        }
+    }
+    delete segment;
+}
+
+/// Improves the precision of an intersection using Newton's method and determines its point.
+static void refineIntersection(CurveIntersection &intersection, const EdgeSegment *aEdge, const EdgeSpan &a, const EdgeSegment *bEdge, const EdgeSpan &b) {
+    CurveIntersection cur = intersection;
+    double error = (aEdge->point(cur.a)-bEdge->point(cur.b)).length();
+    for (int i = 0; i < CURVE_INTERSECTION_REFINE_STEPS && error > 0; ++i) {
+        Vector2 aDir = aEdge->direction(cur.a), bDir = bEdge->direction(cur.b);
+        double det = crossProduct(aDir, bDir);
+        // Nearly tangent intersections are ill-conditioned
+        if (!(fabs(det) > 1e-3*aDir.length()*bDir.length()))
+            break;
+        Vector2 delta = aEdge->point(cur.a)-bEdge->point(cur.b);
+        cur.a -= crossProduct(delta, bDir)/det;
+        cur.b += crossProduct(aDir, delta)/det;
+        if (!(cur.a >= a.t0 && cur.a <= a.t1 && cur.b >= b.t0 && cur.b <= b.t1))
+            break;
+        double newError = (aEdge->point(cur.a)-bEdge->point(cur.b)).length();
+        if (!(newError < error))
+            break;
+        intersection.a = cur.a;
+        intersection.b = cur.b;
+        error = newError;
+    }
+    intersection.point = .5*(aEdge->point(intersection.a)+bEdge->point(intersection.b));
+}
+
+/// Checks if two spans overlap along a common section. Since spans are monotonic, the section must be delimited by their endpoints.
+static bool areCoincident(const EdgeSpan &a, const EdgeSpan &b, double tolerance) {
+    EdgeSegment *aSegment = createSegment(a.p, a.degree), *bSegment = createSegment(b.p, b.degree);
+    double lo = 1, hi = 0, param;
+    for (int i = 0; i < 2; ++i) {
+        if (fabs(bSegment->signedDistance(i ? a.p[a.degree] : a.p[0], param).distance) <= tolerance && param >= 0 && param <= 1) {
+            lo = min(lo, double(i));
+            hi = max(hi, double(i));
+        }
+        if (fabs(aSegment->signedDistance(i ? b.p[b.degree] : b.p[0], param).distance) <= tolerance && param >= 0 && param <= 1) {
+            lo = min(lo, param);
+            hi = max(hi, param);
+        }
+    }
+    bool coincident = false;
+    if (hi > lo && (bezierPoint(a.p, a.degree, hi)-bezierPoint(a.p, a.degree, lo)).length() > tolerance)
+        coincident = fabs(bSegment->signedDistance(bezierPoint(a.p, a.degree, .5*(lo+hi)), param).distance) <= tolerance;
+    delete aSegment;
+    delete bSegment;
+    return coincident;
+}
+
+static void intersectSpans(std::vector<CurveIntersection> &output, const EdgeSpan &a, const EdgeSpan &b, const std::vector<const EdgeSegment *> &edges, double tolerance) {
+    if (areCoincident(a, b, tolerance)) {
+        // Coincident spans only need to be split where the other one ends
+        projectEndpoints(output, a, b, false, tolerance);
+        projectEndpoints(output, b, a, true, tolerance);
+        return;
+    }
+    int steps = CURVE_INTERSECTION_MAX_STEPS;
+    intersectCurves(output, a.p, a.degree, a.t0, a.t1, b.p, b.degree, b.t0, b.t1, tolerance, steps);
+    for (std::vector<CurveIntersection>::iterator intersection = output.begin(); intersection != output.end(); ++intersection)
+        refineIntersection(*intersection, edges[a.edge], a, edges[b.edge], b);
+}
+
+static bool compareEdgeSplits(const EdgeSplit &a, const EdgeSplit &b) {
+    return a.param < b.param;
+}
+
+/// The extent of a span in the active list of the sweep line.
+struct SweepEntry {
+    double xMax, yMin, yMax;
+    int piece;
+};
+
+struct PointCell {
+    long long x, y;
+    int point;
+};
+
+static bool compareCells(const PointCell &a, const PointCell &b) {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+static int findRoot(std::vector<int> &parents, int i) {
+    while (parents[i] != i)
+        i = parents[i] = parents[parents[i]];
+    return i;
+}
+
+/// Merges points closer than tolerance into common vertices.
+static void clusterPoints(std::vector<int> &pointVertices, std::vector<Point2> &vertices, const std::vector<Point2> &points, double tolerance) {
+    int n = (int) points.size();
+    std::vector<PointCell> cells(n);
+    std::vector<int> parents(n);
+    for (int i = 0; i < n; ++i) {
+        cells[i].x = (long long) floor(points[i].x/tolerance);
+        cells[i].y = (long long) floor(points[i].y/tolerance);
+        cells[i].point = i;
+        parents[i] = i;
+    }
+    std::sort(cells.begin(), cells.end(), compareCells);
+    // Points closer than tolerance must be in neighboring cells, so for each cell, the remainder of its column and three cells of the next column are searched
+    for (int i = 0; i < n; ++i) {
+        const PointCell &cell = cells[i];
+        PointCell neighbor = { cell.x+1, cell.y-1, -1 };
+        for (int column = 0; column < 2; ++column) {
+            int j = column ? (int) (std::lower_bound(cells.begin()+i+1, cells.end(), neighbor, compareCells)-cells.begin()) : i+1;
+            for (; j < n && cells[j].x == cell.x+column && cells[j].y <= cell.y+1; ++j) {
+                if ((points[cells[j].point]-points[cell.point]).length() <= tolerance) {
+                    int a = findRoot(parents, cell.point), b = findRoot(parents, cells[j].point);
+                    if (a != b)
+                        parents[max(a, b)] = min(a, b);
+                }
+            }
+        }
+    }
+    pointVertices.resize(n);
+    vertices.clear();
+    for (int i = 0; i < n; ++i) {
+        int root = findRoot(parents, i);
+        if (root == i) {
+            pointVertices[i] = (int) vertices.size();
+            vertices.push_back(points[i]);
+        } else
+            pointVertices[i] = pointVertices[root];
+    }
+}
+
+/// A point whose winding number is determined by casting a ray from it in the negative direction of an axis.
+struct RayQuery {
+    double level, limit;
+    int group;
+};
+
+static bool compareRayQueries(const RayQuery &a, const RayQuery &b) {
+    return a.limit < b.limit;
+}
+
+static double spanMin(const EdgeSpan &span, int axis) {
+    return axis ? span.yMin : span.xMin;
+}
+
+static double spanMax(const EdgeSpan &span, int axis) {
+    return axis ? span.yMax : span.xMax;
+}
+
+/// Checks if a ray along axis at level of the other axis passes through the span's range. The range is half-open so that a ray passing through a vertex crosses exactly one of its spans.
+static bool isInRayRange(const EdgeSpan &span, int axis, double level) {
+    double c0 = coordinate(span.p[0], 1-axis), c1 = coordinate(span.p[span.degree], 1-axis);
+    return min(c0, c1) <= level && level < max(c0, c1);
+}
+
+/// Returns the contribution of the span to the winding number when crossed by a ray. It is consistent with Scanline, which sums the Y directions of intersections left of a point.
+static int crossingDirection(const EdgeSpan &span, int axis) {
+    return (axis ? -1 : 1)*sign(coordinate(span.p[span.degree], 1-axis)-coordinate(span.p[0], 1-axis));
+}
+
+/// Checks if the span crosses the ray at level before it reaches limit. The level must be within the span's range.
+static bool crossesRay(const EdgeSpan &span, int axis, double level, double limit) {
+    if (spanMin(span, axis) >= limit)
+        return false;
+    if (spanMax(span, axis) < limit)
+        return true;
+    bool ascending = coordinate(span.p[0], 1-axis) < coordinate(span.p[span.degree], 1-axis);
+    double lo = 0, hi = 1;
+    for (int i = 0; i < BISECTION_STEPS; ++i) {
+        double mid = .5*(lo+hi);
+        if ((coordinate(bezierPoint(span.p, span.degree, mid), 1-axis) < level) == ascending)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return coordinate(bezierPoint(span.p, span.degree, .5*(lo+hi)), axis) < limit;
+}
+
+static void fenwickAdd(std::vector<int> &tree, int index, int value) {
+    for (++index; index < (int) tree.size(); index += index&-index)
+        tree[index] += value;
+}
+
+static int fenwickPrefixSum(const std::vector<int> &tree, int index) {
+    int sum = 0;
+    for (++index; index > 0; index -= index&-index)
+        sum += tree[index];
+    return sum;
+}
+
+static int levelIndex(const std::vector<double> &levels, double level) {
+    return (int) (std::lower_bound(levels.begin(), levels.end(), level)-levels.begin());
+}
+
+/**
+ * Computes the winding numbers of all queries along the same axis with a single sweep in the direction of their rays.
+ * Spans that have been passed are accumulated in a Fenwick tree indexed by query levels, and only those which overlap
+ * the sweep position are tested individually, looked up by uniform bins of the other axis.
+ * The spans of each query's own group are excluded from its winding number.
+ */
+static void computeWindings(std::vector<int> &windings, std::vector<RayQuery> &queries, const std::vector<EdgeSpan> &spans, const std::vector<int> &groupStart, const std::vector<int> &groupSpans, int axis, double lo, double hi) {
+    if (queries.empty())
+        return;
+    std::vector<double> levels;
+    levels.reserve(queries.size());
+    for (std::vector<RayQuery>::const_iterator query = queries.begin(); query != queries.end(); ++query)
+        levels.push_back(query->level);
+    std::sort(levels.begin(), levels.end());
+    levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+    std::vector<std::pair<double, int> > byMin, byMax;
+    for (int i = 0; i < (int) spans.size(); ++i) {
+        double c0 = coordinate(spans[i].p[0], 1-axis), c1 = coordinate(spans[i].p[spans[i].degree], 1-axis);
+        // Skip spans which no ray passes through
+        if (levelIndex(levels, min(c0, c1)) < levelIndex(levels, max(c0, c1))) {
+            byMin.push_back(std::make_pair(spanMin(spans[i], axis), i));
+            byMax.push_back(std::make_pair(spanMax(spans[i], axis), i));
+        }
+    }
+    std::sort(byMin.begin(), byMin.end());
+    std::sort(byMax.begin(), byMax.end());
+    std::sort(queries.begin(), queries.end(), compareRayQueries);
+
+    std::vector<int> passedWindings(levels.size()+1, 0);
+    int binCount = max(1, (int) sqrt((double) spans.size()));
+    double binScale = hi > lo ? binCount/(hi-lo) : 0;
+    std::vector<std::vector<int> > activeBins(binCount);
+    int passed = 0, entered = 0, spanCount = (int) byMin.size();
+    for (std::vector<RayQuery>::const_iterator query = queries.begin(); query != queries.end(); ++query) {
+        for (; passed < spanCount && byMax[passed].first < query->limit; ++passed) {
+            const EdgeSpan &span = spans[byMax[passed].second];
+            double c0 = coordinate(span.p[0], 1-axis), c1 = coordinate(span.p[span.degree], 1-axis);
+            int direction = crossingDirection(span, axis);
+            fenwickAdd(passedWindings, levelIndex(levels, min(c0, c1)), direction);
+            fenwickAdd(passedWindings, levelIndex(levels, max(c0, c1)), -direction);
+        }
+        for (; entered < spanCount && byMin[entered].first < query->limit; ++entered) {
+            const EdgeSpan &span = spans[byMin[entered].second];
+            double c0 = coordinate(span.p[0], 1-axis), c1 = coordinate(span.p[span.degree], 1-axis);
+            int firstBin = clamp((int) ((min(c0, c1)-lo)*binScale), binCount-1);
+            int lastBin = clamp((int) ((max(c0, c1)-lo)*binScale), binCount-1);
+            for (int bin = firstBin; bin <= lastBin; ++bin)
+                activeBins[bin].push_back(byMin[entered].second);
+        }
+        int winding = fenwickPrefixSum(passedWindings, levelIndex(levels, query->level));
+        std::vector<int> &active = activeBins[clamp((int) ((query->level-lo)*binScale), binCount-1)];
+        int activeCount = 0;
+        for (std::vector<int>::const_iterator i = active.begin(); i != active.end(); ++i) {
+            const EdgeSpan &span = spans[*i];
+            if (spanMax(span, axis) < query->limit)
+                continue;
+            active[activeCount++] = *i;
+            if (span.group != query->group && isInRayRange(span, axis, query->level) && crossesRay(span, axis, query->level, query->limit))
+                winding += crossingDirection(span, axis);
+        }
+        active.resize(activeCount);
+        // Spans of the query's own group might have been passed within tolerance
+        for (int i = groupStart[query->group]; i < groupStart[query->group+1]; ++i) {
+            const EdgeSpan &span = spans[groupSpans[i]];
+            if (spanMax(span, axis) < query->limit && isInRayRange(span, axis, query->level))
+                winding -= crossingDirection(span, axis);
+        }
+        windings[query->group] = winding;
+    }
+}
+
+/// A span of the resulting boundary, which is traversed in reverse if reversed is set.
+struct BoundarySpan {
+    int span;
+    bool reversed;
+};
+
+static void addEdge(Contour &contour, const Point2 *p, int degree) {
+    switch (degree) {
+        case 1:
+            contour.addEdge(EdgeHolder(p[0], p[1]));
+            break;
+        case 2:
+            contour.addEdge(EdgeHolder(p[0], p[1], p[2]));
+            break;
+        case 3:
+            contour.addEdge(EdgeHolder(p[0], p[1], p[2], p[3]));
+            break;
+    }
+}
+
+static bool isContinuation(const EdgeSpan &a, const EdgeSpan &b, bool reversed) {
+    return a.edge == b.edge && (reversed ? a.t0 == b.t1 : a.t1 == b.t0);
+}
+
+/// Converts a closed chain of boundary spans into a contour, rejoining consecutive spans of the same original edge.
+static void buildContour(Contour &contour, const std::vector<BoundarySpan> &chain, const std::vector<EdgeSpan> &spans, const std::vector<const EdgeSegment *> &edges, const std::vector<Point2> &vertices) {
+    int n = (int) chain.size();
+    int start = 0;
+    for (int i = 0; i < n; ++i) {
+        const BoundarySpan &prev = chain[(i+n-1)%n], &cur = chain[i];
+        if (!(prev.reversed == cur.reversed && isContinuation(spans[prev.span], spans[cur.span], cur.reversed))) {
+            start = i;
+            break;
+        }
+    }
+    for (int i = 0; i < n;) {
+        const BoundarySpan &first = chain[(start+i)%n];
+        int last = i;
+        while (last+1 < n) {
+            const BoundarySpan &next = chain[(start+last+1)%n];
+            if (!(next.reversed == first.reversed && isContinuation(spans[chain[(start+last)%n].span], spans[next.span], first.reversed)))
+                break;
+            ++last;
+        }
+        const EdgeSpan &firstSpan = spans[first.span], &lastSpan = spans[chain[(start+last)%n].span];
+        const EdgeSegment *edge = edges[firstSpan.edge];
+        int degree = firstSpan.degree;
+        Point2 p[4];
+        if (first.reversed) {
+            Point2 q[4];
+            extractBezier(q, edge->controlPoints(), degree, lastSpan.t0, firstSpan.t1);
+            for (int j = 0; j <= degree; ++j)
+                p[j] = q[degree-j];
+            p[0] = vertices[firstSpan.v1];
+            p[degree] = vertices[lastSpan.v0];
+        } else {
+            extractBezier(p, edge->controlPoints(), degree, firstSpan.t0, lastSpan.t1);
+            p[0] = vertices[firstSpan.v0];
+            p[degree] = vertices[lastSpan.v1];
+        }
+        addEdge(contour, p, degree);
+        i = last+1;
+    }
+}
+
+bool resolveShapeOverlaps(Shape &shape, FillRule fillRule) {
+    std::vector<const EdgeSegment *> edges;
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour)
+        for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge)
+            edges.push_back(*edge);
+    int edgeCount = (int) edges.size();
+    if (!edgeCount) {
+        shape.contours.clear();
+        return true;
+    }
+    Shape::Bounds bounds = shape.getBounds();
+    double tolerance = OVERLAP_TOLERANCE*max(max(bounds.r-bounds.l, bounds.t-bounds.b), 1e-300);
+
+    // Split edges into monotonic spans
+    std::vector<std::vector<EdgeSplit> > splits(edgeCount);
+    std::vector<EdgeSpan> pieces;
+    for (int i = 0; i < edgeCount; ++i) {
+        double params[6];
+        int paramCount = extremeParams(params, edges[i]->controlPoints(), edgeDegree(edges[i]));
+        // extremeParams never exceeds the bound, which only lets the compiler prove that params is large enough
+        std::sort(params, params+min(paramCount, 6));
+        double prevParam = 0;
+        for (int j = 0; j <= paramCount; ++j) {
+            double param = j < paramCount ? params[j] : 1;
+            if (param > prevParam) {
+                pieces.push_back(makeSpan(edges[i], i, prevParam, param));
+                prevParam = param;
+            }
+        }
+        for (int j = 0; j < paramCount; ++j) {
+            EdgeSplit split = { params[j], -1 };
+            splits[i].push_back(split);
+        }
+    }
+
+    // Find intersections of monotonic spans using a sweep line along the X axis
+    std::vector<std::pair<int, int> > candidates;
+    {
+        int pieceCount = (int) pieces.size();
+        std::vector<std::pair<double, int> > order(pieceCount);
+        for (int i = 0; i < pieceCount; ++i)
+            order[i] = std::make_pair(pieces[i].xMin, i);
+        std::sort(order.begin(), order.end());
+        std::vector<SweepEntry> active;
+        for (std::vector<std::pair<double, int> >::const_iterator i = order.begin(); i != order.end(); ++i) {
+            const EdgeSpan &piece = pieces[i->second];
+            int activeCount = 0;
+            for (std::vector<SweepEntry>::const_iterator j = active.begin(); j != active.end(); ++j) {
+                if (j->xMax+tolerance < piece.xMin)
+                    continue;
+                active[activeCount++] = *j;
+                if (j->yMax+tolerance < piece.yMin || piece.yMax+tolerance < j->yMin)
+                    continue;
+                // Neighboring monotonic spans of the same edge only touch at their common endpoint
+                const EdgeSpan &other = pieces[j->piece];
+                if (other.edge == piece.edge && (other.t1 == piece.t0 || piece.t1 == other.t0))
+                    continue;
+                candidates.push_back(std::make_pair(j->piece, i->second));
+            }
+            active.resize(activeCount);
+            SweepEntry entry = { piece.xMax, piece.yMin, piece.yMax, i->second };
+            active.push_back(entry);
+        }
+    }
+    int candidateCount = (int) candidates.size();
+    std::vector<Point2> intersectionPoints;
+#ifdef MSDFGEN_USE_OPENMP
+    #pragma omp parallel for
+#endif
+    for (int i = 0; i < candidateCount; ++i) {
+        const EdgeSpan &a = pieces[candidates[i].first], &b = pieces[candidates[i].second];
+        std::vector<CurveIntersection> intersections;
+        intersectSpans(intersections, a, b, edges, tolerance);
+        if (!intersections.empty()) {
+#ifdef MSDFGEN_USE_OPENMP
+            #pragma omp critical
+#endif
+            {
+                for (std::vector<CurveIntersection>::const_iterator intersection = intersections.begin(); intersection != intersections.end(); ++intersection) {
+                    EdgeSplit split = { 0, (int) intersectionPoints.size() };
+                    intersectionPoints.push_back(intersection->point);
+                    if (intersection->a > 0 && intersection->a < 1) {
+                        split.param = intersection->a;
+                        splits[a.edge].push_back(split);
+                    }
+                    if (intersection->b > 0 && intersection->b < 1) {
+                        split.param = intersection->b;
+                        splits[b.edge].push_back(split);
+                    }
+                }
+            }
+        }
+    }
+
+    // Split edges at intersections and merge coincident endpoints
+    std::vector<EdgeSpan> spans;
+    for (int i = 0; i < edgeCount; ++i) {
+        std::vector<EdgeSplit> &edgeSplits = splits[i];
+        std::sort(edgeSplits.begin(), edgeSplits.end(), compareEdgeSplits);
+        EdgeSplit end = { 1, -1 };
+        edgeSplits.push_back(end);
+        EdgeSplit prev = { 0, -1 };
+        for (std::vector<EdgeSplit>::const_iterator split = edgeSplits.begin(); split != edgeSplits.end(); ++split) {
+            if (split->param > prev.param) {
+                EdgeSpan span = makeSpan(edges[i], i, prev.param, split->param);
+                // Both edges split at an intersection must share its endpoint exactly
+                if (prev.point >= 0)
+                    span.p[0] = intersectionPoints[prev.point];
+                if (split->point >= 0)
+                    span.p[span.degree] = intersectionPoints[split->point];
+                spans.push_back(span);
+                prev = *split;
+            }
+        }
+    }
+    std::vector<Point2> vertices;
+    {
+        std::vector<Point2> endpoints;
+        endpoints.reserve(2*spans.size());
+        for (std::vector<EdgeSpan>::const_iterator span = spans.begin(); span != spans.end(); ++span) {
+            endpoints.push_back(span->p[0]);
+            endpoints.push_back(span->p[span->degree]);
+        }
+        std::vector<int> endpointVertices;
+        clusterPoints(endpointVertices, vertices, endpoints, tolerance);
+        int spanCount = 0;
+        for (int i = 0; i < (int) spans.size(); ++i) {
+            EdgeSpan span = spans[i];
+            span.v0 = endpointVertices[2*i];
+            span.v1 = endpointVertices[2*i+1];
+            // Spans shorter than tolerance are dropped
+            if (span.v0 == span.v1)
+                continue;
+            span.p[0] = vertices[span.v0];
+            span.p[span.degree] = vertices[span.v1];
+            boundSpan(span);
+            spans[spanCount++] = span;
+        }
+        spans.resize(spanCount);
+    }
+    int spanCount = (int) spans.size();
+
+    // Group coincident spans, which must be classified together
+    std::vector<int> groupRepresentatives;
+    {
+        // Spans are sorted by their (unordered) pair of endpoint vertices
+        std::vector<std::pair<long long, int> > order(spanCount);
+        for (int i = 0; i < spanCount; ++i)
+            order[i] = std::make_pair((long long) min(spans[i].v0, spans[i].v1)<<32|max(spans[i].v0, spans[i].v1), i);
+        std::sort(order.begin(), order.end());
+        for (int i = 0; i < spanCount;) {
+            int end = i+1;
+            while (end < spanCount && order[end].first == order[i].first)
+                ++end;
+            for (int j = i; j < end; ++j) {
+                EdgeSpan &span = spans[order[j].second];
+                Point2 midpoint = bezierPoint(span.p, span.degree, .5);
+                for (int k = i; k < j; ++k) {
+                    const EdgeSpan &other = spans[order[k].second];
+                    if ((bezierPoint(other.p, other.degree, .5)-midpoint).length() <= 64*tolerance) {
+                        span.group = other.group;
+                        break;
+                    }
+                }
+                if (span.group < 0) {
+                    span.group = (int) groupRepresentatives.size();
+                    groupRepresentatives.push_back(order[j].second);
+                }
+            }
+            i = end;
+        }
+    }
+
+    // Classify spans by evaluating the winding number on both of their sides
+    int groupCount = (int) groupRepresentatives.size();
+    std::vector<int> groupOrientations(groupCount);
+    std::vector<int> groupStart(groupCount+1, 0), groupSpans(spanCount);
+    for (int i = 0; i < spanCount; ++i)
+        ++groupStart[spans[i].group+1];
+    for (int i = 0; i < groupCount; ++i)
+        groupStart[i+1] += groupStart[i];
+    {
+        std::vector<int> groupEnd(groupStart.begin(), groupStart.end()-1);
+        for (int i = 0; i < spanCount; ++i)
+            groupSpans[groupEnd[spans[i].group]++] = i;
+    }
+    // Mostly vertical spans are probed by a horizontal ray (axis 0) and vice versa
+    std::vector<RayQuery> queries[2];
+    for (int i = 0; i < groupCount; ++i) {
+        const EdgeSpan &span = spans[groupRepresentatives[i]];
+        Vector2 chord = span.p[span.degree]-span.p[0];
+        int axis = fabs(chord.y) >= fabs(chord.x) ? 0 : 1;
+        Point2 midpoint = bezierPoint(span.p, span.degree, .5);
+        RayQuery query;
+        query.level = coordinate(midpoint, 1-axis);
+        query.limit = coordinate(midpoint, axis);
+        query.group = i;
+        queries[axis].push_back(query);
+    }
+    std::vector<int> windings(groupCount);
+    computeWindings(windings, queries[0], spans, groupStart, groupSpans, 0, bounds.b, bounds.t);
+    computeWindings(windings, queries[1], spans, groupStart, groupSpans, 1, bounds.l, bounds.r);
+    for (int i = 0; i < groupCount; ++i) {
+        const EdgeSpan &span = spans[groupRepresentatives[i]];
+        Vector2 chord = span.p[span.degree]-span.p[0];
+        int axis = fabs(chord.y) >= fabs(chord.x) ? 0 : 1;
+        int groupDirection = 0;
+        for (int j = groupStart[i]; j < groupStart[i+1]; ++j)
+            groupDirection += crossingDirection(spans[groupSpans[j]], axis);
+        bool filledLow = interpretFillRule(windings[i], fillRule);
+        bool filledHigh = interpretFillRule(windings[i]+groupDirection, fillRule);
+        if (filledLow == filledHigh)
+            groupOrientations[i] = 0;
+        else {
+            // The filled area must be on the right side of the boundary
+            bool positive = axis ? filledLow : filledHigh;
+            groupOrientations[i] = positive == (coordinate(chord, 1-axis) > 0) ? 1 : -1;
+        }
+    }
+
+    // Link boundary spans into closed contours
+    int vertexCount = (int) vertices.size();
+    std::vector<BoundarySpan> boundary;
+    std::vector<int> outgoingStart(vertexCount+1, 0);
+    for (int i = 0; i < groupCount; ++i) {
+        if (groupOrientations[i]) {
+            BoundarySpan boundarySpan;
+            boundarySpan.span = groupRepresentatives[i];
+            boundarySpan.reversed = groupOrientations[i] < 0;
+            boundary.push_back(boundarySpan);
+            const EdgeSpan &span = spans[boundarySpan.span];
+            ++outgoingStart[(boundarySpan.reversed ? span.v1 : span.v0)+1];
+        }
+    }
+    for (int i = 0; i < vertexCount; ++i)
+        outgoingStart[i+1] += outgoingStart[i];
+    int boundaryCount = (int) boundary.size();
+    std::vector<int> outgoing(boundaryCount);
+    {
+        std::vector<int> outgoingEnd(outgoingStart.begin(), outgoingStart.end()-1);
+        for (int i = 0; i < boundaryCount; ++i) {
+            const EdgeSpan &span = spans[boundary[i].span];
+            outgoing[outgoingEnd[boundary[i].reversed ? span.v1 : span.v0]++] = i;
+        }
+    }
+    std::vector<bool> used(boundaryCount, false);
+    std::vector<Contour> contours;
+    std::vector<BoundarySpan> chain;
+    for (int i = 0; i < boundaryCount; ++i) {
+        if (used[i])
+            continue;
+        chain.clear();
+        const EdgeSpan &firstSpan = spans[boundary[i].span];
+        int startVertex = boundary[i].reversed ? firstSpan.v1 : firstSpan.v0;
+        for (int cur = i; cur >= 0;) {
+            used[cur] = true;
+            chain.push_back(boundary[cur]);
+            const EdgeSpan &span = spans[boundary[cur].span];
+            int vertex = boundary[cur].reversed ? span.v0 : span.v1;
+            if (vertex == startVertex)
+                break;
+            cur = -1;
+            for (int j = outgoingStart[vertex]; j < outgoingStart[vertex+1]; ++j) {
+                if (!used[outgoing[j]]) {
+                    cur = outgoing[j];
+                    break;
+                }
+            }
+            // The boundary of the filled area must be closed
+            if (cur < 0)
+                return false;
+        }
+        contours.resize(contours.size()+1);
+        buildContour(contours.back(), chain, spans, edges, vertices);
+    }
+    shape.contours.swap(contours);
+    return true;
+}
+
+}
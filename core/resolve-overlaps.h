@@ -0,0 +1,12 @@
+
+#pragma once
+
+#include "Shape.h"
+#include "Scanline.h"
+
+namespace msdfgen {
+
+/// Resolves any intersections within the shape by splitting its edges at the points of intersection and only keeping the boundary of the filled area, which also gives its contours a consistent winding.
+bool resolveShapeOverlaps(Shape &shape, FillRule fillRule = FILL_NONZERO);
+
+}
@@ -30,14 +30,24 @@ static void writeValueRepeated(FILE *file, T value, int times) {
         writeValue(file, value);
 }
 
-static bool writeTiffHeader(FILE *file, int width, int height, int channels) {
+static bool writeTiffHeader(FILE *file) {
     #ifdef __BIG_ENDIAN__
         writeValue<uint16_t>(file, 0x4d4du);
     #else
         writeValue<uint16_t>(file, 0x4949u);
     #endif
     writeValue<uint16_t>(file, 42);
-    writeValue<uint32_t>(file, 0x0008u); // Offset of first IFD
+    return writeValue<uint32_t>(file, 0x0008u); // Offset of first IFD
+}
+
+/// Size of an IFD and its data preceding the pixel data.
+static uint32_t tiffIfdSize(int channels) {
+    return 0x00cau+(channels > 1)*channels*12;
+}
+
+/// Writes the IFD located at ifdOffset, followed by its data. Offsets in comments are for the first IFD at 0x0008.
+static bool writeTiffIfd(FILE *file, uint32_t ifdOffset, int width, int height, int channels, uint32_t nextIfdOffset) {
+    uint32_t base = ifdOffset-0x0008u;
     // Offset = 0x0008
 
     writeValue<uint16_t>(file, 15); // Number of IFD entries
@@ -57,7 +67,7 @@ static bool writeTiffHeader(FILE *file, int width, int height, int channels) {
     writeValue<uint16_t>(file, 0x0003u);
     writeValue<uint32_t>(file, channels);
     if (channels > 1)
-        writeValue<uint32_t>(file, 0x00c2u); // Offset of 32, 32, ...
+        writeValue<uint32_t>(file, base+0x00c2u); // Offset of 32, 32, ...
     else {
         writeValue<uint16_t>(file, 32);
         writeValue<uint16_t>(file, 0);
@@ -78,7 +88,7 @@ static bool writeTiffHeader(FILE *file, int width, int height, int channels) {
     writeValue<uint16_t>(file, 0x0111u);
     writeValue<uint16_t>(file, 0x0004u);
     writeValue<uint32_t>(file, 1);
-    writeValue<uint32_t>(file, 0x00d2u+(channels > 1)*channels*12); // Offset of pixel data
+    writeValue<uint32_t>(file, base+0x00d2u+(channels > 1)*channels*12); // Offset of pixel data
     // SamplesPerPixel
     writeValue<uint16_t>(file, 0x0115u);
     writeValue<uint16_t>(file, 0x0003u);
@@ -99,12 +109,12 @@ static bool writeTiffHeader(FILE *file, int width, int height, int channels) {
     writeValue<uint16_t>(file, 0x011au);
     writeValue<uint16_t>(file, 0x0005u);
     writeValue<uint32_t>(file, 1);
-    writeValue<uint32_t>(file, 0x00c2u+(channels > 1)*channels*2); // Offset of 300, 1
+    writeValue<uint32_t>(file, base+0x00c2u+(channels > 1)*channels*2); // Offset of 300, 1
     // YResolution
     writeValue<uint16_t>(file, 0x011bu);
     writeValue<uint16_t>(file, 0x0005u);
     writeValue<uint32_t>(file, 1);
-    writeValue<uint32_t>(file, 0x00cau+(channels > 1)*channels*2); // Offset of 300, 1
+    writeValue<uint32_t>(file, base+0x00cau+(channels > 1)*channels*2); // Offset of 300, 1
     // ResolutionUnit
     writeValue<uint16_t>(file, 0x0128u);
     writeValue<uint16_t>(file, 0x0003u);
@@ -116,7 +126,7 @@ static bool writeTiffHeader(FILE *file, int width, int height, int channels) {
     writeValue<uint16_t>(file, 0x0003u);
     writeValue<uint32_t>(file, channels);
     if (channels > 1)
-        writeValue<uint32_t>(file, 0x00d2u+channels*2); // Offset of 3, 3, ...
+        writeValue<uint32_t>(file, base+0x00d2u+channels*2); // Offset of 3, 3, ...
     else {
         writeValue<uint16_t>(file, 3);
         writeValue<uint16_t>(file, 0);
@@ -126,7 +136,7 @@ static bool writeTiffHeader(FILE *file, int width, int height, int channels) {
     writeValue<uint16_t>(file, 0x000bu);
     writeValue<uint32_t>(file, channels);
     if (channels > 1)
-        writeValue<uint32_t>(file, 0x00d2u+channels*4); // Offset of 0.f, 0.f, ...
+        writeValue<uint32_t>(file, base+0x00d2u+channels*4); // Offset of 0.f, 0.f, ...
     else
         writeValue<float>(file, 0.f);
     // SMaxSampleValue
@@ -134,12 +144,12 @@ static bool writeTiffHeader(FILE *file, int width, int height, int channels) {
     writeValue<uint16_t>(file, 0x000bu);
     writeValue<uint32_t>(file, channels);
     if (channels > 1)
-        writeValue<uint32_t>(file, 0x00d2u+channels*8); // Offset of 1.f, 1.f, ...
+        writeValue<uint32_t>(file, base+0x00d2u+channels*8); // Offset of 1.f, 1.f, ...
     else
         writeValue<float>(file, 1.f);
     // Offset = 0x00be
 
-    writeValue<uint32_t>(file, 0);
+    writeValue<uint32_t>(file, nextIfdOffset);
 
     if (channels > 1) {
         // 0x00c2 BitsPerSample data
@@ -171,25 +181,42 @@ static bool writeTiffHeader(FILE *file, int width, int height, int channels) {
 }
 
 template <int N>
-bool saveTiffFloat(BitmapConstSection<float, N> bitmap, const char *filename) {
+static bool saveTiffFloat(const BitmapConstSection<float, N> *levels, int levelCount, const char *filename) {
     FILE *file = fopen(filename, "wb");
     if (!file)
         return false;
-    bitmap.reorient(Y_DOWNWARD);
-    writeTiffHeader(file, bitmap.width, bitmap.height, N);
-    for (int y = 0; y < bitmap.height; ++y)
-        fwrite(bitmap(0, y), sizeof(float), N*bitmap.width, file);
+    writeTiffHeader(file);
+    uint32_t ifdOffset = 0x0008u;
+    for (int level = 0; level < levelCount; ++level) {
+        BitmapConstSection<float, N> bitmap = levels[level];
+        bitmap.reorient(Y_DOWNWARD);
+        uint32_t nextIfdOffset = level+1 < levelCount ? ifdOffset+tiffIfdSize(N)+uint32_t(sizeof(float)*N*bitmap.width*bitmap.height) : 0;
+        writeTiffIfd(file, ifdOffset, bitmap.width, bitmap.height, N, nextIfdOffset);
+        for (int y = 0; y < bitmap.height; ++y)
+            fwrite(bitmap(0, y), sizeof(float), N*bitmap.width, file);
+        ifdOffset = nextIfdOffset;
+    }
     return !fclose(file);
 }
 
 bool saveTiff(const BitmapConstSection<float, 1> &bitmap, const char *filename) {
-    return saveTiffFloat(bitmap, filename);
+    return saveTiffFloat(&bitmap, 1, filename);
 }
 bool saveTiff(const BitmapConstSection<float, 3> &bitmap, const char *filename) {
-    return saveTiffFloat(bitmap, filename);
+    return saveTiffFloat(&bitmap, 1, filename);
 }
 bool saveTiff(const BitmapConstSection<float, 4> &bitmap, const char *filename) {
-    return saveTiffFloat(bitmap, filename);
+    return saveTiffFloat(&bitmap, 1, filename);
+}
+
+bool saveTiff(const BitmapConstSection<float, 1> *levels, int levelCount, const char *filename) {
+    return saveTiffFloat(levels, levelCount, filename);
+}
+bool saveTiff(const BitmapConstSection<float, 3> *levels, int levelCount, const char *filename) {
+    return saveTiffFloat(levels, levelCount, filename);
+}
+bool saveTiff(const BitmapConstSection<float, 4> *levels, int levelCount, const char *filename) {
+    return saveTiffFloat(levels, levelCount, filename);
 }
 
 }
@@ -10,4 +10,9 @@ bool saveTiff(const BitmapConstSection<float, 1> &bitmap, const char *filename);
 bool saveTiff(const BitmapConstSection<float, 3> &bitmap, const char *filename);
 bool saveTiff(const BitmapConstSection<float, 4> &bitmap, const char *filename);
 
+/// Saves the bitmaps, such as the levels of a mipmap chain, as successive images of an uncompressed floating-point TIFF file.
+bool saveTiff(const BitmapConstSection<float, 1> *levels, int levelCount, const char *filename);
+bool saveTiff(const BitmapConstSection<float, 3> *levels, int levelCount, const char *filename);
+bool saveTiff(const BitmapConstSection<float, 4> *levels, int levelCount, const char *filename);
+
 }
@@ -0,0 +1,291 @@
+
+#include "shape-binary.h"
+
+#include <cstring>
+#include "arithmetics.hpp"
+
+namespace msdfgen {
+
+/*
+ * Binary shape format (all values little-endian):
+ *  - 24-byte header: "MSHP", uint16 version, uint16 flags, uint32 contour count, uint32 edge count, uint32 point count, uint32 total size
+ *  - if SHAPE_BINARY_BOUNDS flag is set: 4 x float64 bounds (l, b, r, t)
+ *  - point count x 2 x float64 control points, without the end point of each edge, which is the start point of the next edge in the contour
+ *  - contour count x 2 x uint32 cumulative edge count and point count at the end of each contour
+ *  - edge count x uint8 edge descriptor (edge type | color<<2)
+ *  - padding to a multiple of 8 bytes
+ */
+
+#define SHAPE_BINARY_HEADER_SIZE 24
+#define SHAPE_BINARY_BOUNDS_SIZE 32
+// Number of bytes read from a file at once, so that a corrupt size in the header cannot allocate much more memory than the file actually contains
+#define SHAPE_BINARY_READ_CHUNK_SIZE 65536
+
+enum {
+    SHAPE_BINARY_Y_DOWNWARD = 0x01,
+    SHAPE_BINARY_COLORS = 0x02,
+    SHAPE_BINARY_BOUNDS = 0x04
+};
+
+static void writeUint16(byte *dst, unsigned value) {
+    dst[0] = byte(value);
+    dst[1] = byte(value>>8);
+}
+
+static void writeUint32(byte *dst, unsigned value) {
+    dst[0] = byte(value);
+    dst[1] = byte(value>>8);
+    dst[2] = byte(value>>16);
+    dst[3] = byte(value>>24);
+}
+
+static void writeFloat64(byte *dst, double value) {
+    unsigned long long bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i)
+        dst[i] = byte(bits>>8*i);
+}
+
+static unsigned readUint16(const byte *src) {
+    return unsigned(src[0])|unsigned(src[1])<<8;
+}
+
+static unsigned readUint32(const byte *src) {
+    return unsigned(src[0])|unsigned(src[1])<<8|unsigned(src[2])<<16|unsigned(src[3])<<24;
+}
+
+static double readFloat64(const byte *src) {
+    unsigned long long bits = 0;
+    for (int i = 0; i < 8; ++i)
+        bits |= (unsigned long long) src[i]<<8*i;
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static Point2 readPoint(const byte *points, int index) {
+    return Point2(readFloat64(points+16*index), readFloat64(points+16*index+8));
+}
+
+ShapeBinaryView::ShapeBinaryView() : header(), points(), contourEnds(), edgeDescriptors(), totalSize(), nContours(), nEdges(), flags() { }
+
+bool ShapeBinaryView::open(const void *data, size_t length) {
+    const byte *src = reinterpret_cast<const byte *>(data);
+    *this = ShapeBinaryView();
+    if (!(length >= SHAPE_BINARY_HEADER_SIZE && !memcmp(src, "MSHP", 4) && readUint16(src+4) == MSDFGEN_SHAPE_BINARY_VERSION))
+        return false;
+    int fileFlags = readUint16(src+6);
+    size_t contourCount = readUint32(src+8), edgeCount = readUint32(src+12), pointCount = readUint32(src+16), size = readUint32(src+20);
+    size_t pointsOffset = SHAPE_BINARY_HEADER_SIZE+(fileFlags&SHAPE_BINARY_BOUNDS ? SHAPE_BINARY_BOUNDS_SIZE : 0);
+    size_t contourEndsOffset = pointsOffset+16*pointCount;
+    size_t edgeDescriptorsOffset = contourEndsOffset+8*contourCount;
+    if (!(size <= length && edgeDescriptorsOffset+edgeCount <= size && contourCount < 0x80000000u && edgeCount < 0x80000000u))
+        return false;
+    // Validate that contour ends are monotonic and consistent with edge types
+    size_t prevEdgeEnd = 0, prevPointEnd = 0;
+    for (size_t i = 0; i < contourCount; ++i) {
+        size_t edgeEnd = readUint32(src+contourEndsOffset+8*i), pointEnd = readUint32(src+contourEndsOffset+8*i+4);
+        if (!(edgeEnd >= prevEdgeEnd && edgeEnd <= edgeCount && pointEnd >= prevPointEnd))
+            return false;
+        size_t contourPoints = 0;
+        for (size_t j = prevEdgeEnd; j < edgeEnd; ++j) {
+            int edgeType = src[edgeDescriptorsOffset+j]&0x03;
+            if (!edgeType)
+                return false;
+            contourPoints += edgeType;
+        }
+        if (pointEnd-prevPointEnd != contourPoints)
+            return false;
+        prevEdgeEnd = edgeEnd, prevPointEnd = pointEnd;
+    }
+    if (!(prevEdgeEnd == edgeCount && prevPointEnd == pointCount))
+        return false;
+    header = src;
+    points = src+pointsOffset;
+    contourEnds = src+contourEndsOffset;
+    edgeDescriptors = src+edgeDescriptorsOffset;
+    totalSize = size;
+    nContours = int(contourCount);
+    nEdges = int(edgeCount);
+    flags = fileFlags;
+    return true;
+}
+
+size_t ShapeBinaryView::size() const {
+    return totalSize;
+}
+
+int ShapeBinaryView::contourCount() const {
+    return nContours;
+}
+
+int ShapeBinaryView::edgeCount() const {
+    return nEdges;
+}
+
+int ShapeBinaryView::contourStart(int contourIndex) const {
+    return contourIndex > 0 ? int(readUint32(contourEnds+8*(contourIndex-1))) : 0;
+}
+
+int ShapeBinaryView::contourEdgeCount(int contourIndex) const {
+    return int(readUint32(contourEnds+8*contourIndex))-contourStart(contourIndex);
+}
+
+YAxisOrientation ShapeBinaryView::getYAxisOrientation() const {
+    return flags&SHAPE_BINARY_Y_DOWNWARD ? Y_DOWNWARD : Y_UPWARD;
+}
+
+bool ShapeBinaryView::colorsSpecified() const {
+    return (flags&SHAPE_BINARY_COLORS) != 0;
+}
+
+bool ShapeBinaryView::getBounds(Shape::Bounds &bounds) const {
+    if (!(flags&SHAPE_BINARY_BOUNDS))
+        return false;
+    const byte *src = header+SHAPE_BINARY_HEADER_SIZE;
+    bounds.l = readFloat64(src);
+    bounds.b = readFloat64(src+8);
+    bounds.r = readFloat64(src+16);
+    bounds.t = readFloat64(src+24);
+    return true;
+}
+
+void ShapeBinaryView::getContour(int contourIndex, Contour &output) const {
+    int edgeStart = contourStart(contourIndex), edgeEnd = int(readUint32(contourEnds+8*contourIndex));
+    int pointStart = contourIndex > 0 ? int(readUint32(contourEnds+8*contourIndex-4)) : 0;
+    output.edges.clear();
+    output.edges.reserve(edgeEnd-edgeStart);
+    int pointIndex = pointStart;
+    for (int i = edgeStart; i < edgeEnd; ++i) {
+        int edgeType = edgeDescriptors[i]&0x03;
+        EdgeColor color = EdgeColor(edgeDescriptors[i]>>2&0x07);
+        Point2 p[4];
+        for (int j = 0; j < edgeType; ++j)
+            p[j] = readPoint(points, pointIndex++);
+        // End point is the start point of the next edge or the first edge if this is the last one
+        p[edgeType] = readPoint(points, i+1 < edgeEnd ? pointIndex : pointStart);
+        switch (edgeType) {
+            case (int) LinearSegment::EDGE_TYPE:
+                output.addEdge(EdgeHolder(p[0], p[1], color));
+                break;
+            case (int) QuadraticSegment::EDGE_TYPE:
+                output.addEdge(EdgeHolder(p[0], p[1], p[2], color));
+                break;
+            case (int) CubicSegment::EDGE_TYPE:
+                output.addEdge(EdgeHolder(p[0], p[1], p[2], p[3], color));
+                break;
+        }
+    }
+}
+
+void ShapeBinaryView::getShape(Shape &output) const {
+    output.contours.clear();
+    output.contours.resize(nContours);
+    output.setYAxisOrientation(getYAxisOrientation());
+    for (int i = 0; i < nContours; ++i)
+        getContour(i, output.contours[i]);
+}
+
+static bool isColored(const Shape &shape) {
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour)
+        for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge)
+            if ((*edge)->color != WHITE)
+                return true;
+    return false;
+}
+
+bool writeShapeBinary(std::vector<byte> &output, const Shape &shape, bool includeBounds) {
+    if (!shape.validate())
+        return false;
+    size_t edgeCount = 0, pointCount = 0;
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
+        for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+            ++edgeCount;
+            pointCount += (*edge)->type();
+        }
+    }
+    size_t pointsOffset = SHAPE_BINARY_HEADER_SIZE+(includeBounds ? SHAPE_BINARY_BOUNDS_SIZE : 0);
+    size_t contourEndsOffset = pointsOffset+16*pointCount;
+    size_t edgeDescriptorsOffset = contourEndsOffset+8*shape.contours.size();
+    size_t size = (edgeDescriptorsOffset+edgeCount+7)&~size_t(7);
+    if (size > 0xffffffffu)
+        return false;
+
+    size_t start = output.size();
+    output.resize(start+size, byte(0));
+    byte *dst = &output[start];
+    int fileFlags = 0;
+    if (shape.getYAxisOrientation() == Y_DOWNWARD)
+        fileFlags |= SHAPE_BINARY_Y_DOWNWARD;
+    if (isColored(shape))
+        fileFlags |= SHAPE_BINARY_COLORS;
+    if (includeBounds)
+        fileFlags |= SHAPE_BINARY_BOUNDS;
+    memcpy(dst, "MSHP", 4);
+    writeUint16(dst+4, MSDFGEN_SHAPE_BINARY_VERSION);
+    writeUint16(dst+6, fileFlags);
+    writeUint32(dst+8, unsigned(shape.contours.size()));
+    writeUint32(dst+12, unsigned(edgeCount));
+    writeUint32(dst+16, unsigned(pointCount));
+    writeUint32(dst+20, unsigned(size));
+    if (includeBounds) {
+        Shape::Bounds bounds = shape.getBounds();
+        writeFloat64(dst+SHAPE_BINARY_HEADER_SIZE, bounds.l);
+        writeFloat64(dst+SHAPE_BINARY_HEADER_SIZE+8, bounds.b);
+        writeFloat64(dst+SHAPE_BINARY_HEADER_SIZE+16, bounds.r);
+        writeFloat64(dst+SHAPE_BINARY_HEADER_SIZE+24, bounds.t);
+    }
+    byte *pointDst = dst+pointsOffset, *contourEndDst = dst+contourEndsOffset, *edgeDescriptorDst = dst+edgeDescriptorsOffset;
+    unsigned edgeEnd = 0, pointEnd = 0;
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
+        for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+            int edgeType = (*edge)->type();
+            const Point2 *p = (*edge)->controlPoints();
+            for (int i = 0; i < edgeType; ++i) {
+                writeFloat64(pointDst, p[i].x);
+                writeFloat64(pointDst+8, p[i].y);
+                pointDst += 16;
+            }
+            *edgeDescriptorDst++ = byte(edgeType|(*edge)->color<<2);
+            ++edgeEnd;
+            pointEnd += edgeType;
+        }
+        writeUint32(contourEndDst, edgeEnd);
+        writeUint32(contourEndDst+4, pointEnd);
+        contourEndDst += 8;
+    }
+    return true;
+}
+
+bool writeShapeBinary(FILE *output, const Shape &shape, bool includeBounds) {
+    std::vector<byte> buffer;
+    return writeShapeBinary(buffer, shape, includeBounds) && fwrite(&buffer[0], 1, buffer.size(), output) == buffer.size();
+}
+
+bool readShapeBinary(const void *data, size_t length, Shape &output, bool *colorsSpecified) {
+    ShapeBinaryView view;
+    if (!view.open(data, length))
+        return false;
+    view.getShape(output);
+    if (colorsSpecified)
+        *colorsSpecified = view.colorsSpecified();
+    return true;
+}
+
+bool readShapeBinary(FILE *input, Shape &output, bool *colorsSpecified) {
+    std::vector<byte> buffer(SHAPE_BINARY_HEADER_SIZE);
+    if (fread(&buffer[0], 1, SHAPE_BINARY_HEADER_SIZE, input) != SHAPE_BINARY_HEADER_SIZE)
+        return false;
+    size_t size = readUint32(&buffer[20]);
+    if (size < SHAPE_BINARY_HEADER_SIZE)
+        return false;
+    while (buffer.size() < size) {
+        size_t offset = buffer.size(), chunkSize = min(size-offset, (size_t) SHAPE_BINARY_READ_CHUNK_SIZE);
+        buffer.resize(offset+chunkSize);
+        if (fread(&buffer[offset], 1, chunkSize, input) != chunkSize)
+            return false;
+    }
+    return readShapeBinary(&buffer[0], size, output, colorsSpecified);
+}
+
+}
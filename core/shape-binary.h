@@ -0,0 +1,62 @@
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+#include "base.h"
+#include "Shape.h"
+
+namespace msdfgen {
+
+#define MSDFGEN_SHAPE_BINARY_VERSION 1
+
+/// A read-only view of a shape serialized in the binary shape format, which validates it and decodes its contours on demand.
+/// The data is referenced rather than copied, so it must outlive the view. Distance fields are only generated from a decoded Shape.
+class ShapeBinaryView {
+
+public:
+    ShapeBinaryView();
+    /// Sets up the view of the binary shape at the beginning of data. Returns false if data doesn't start with a valid binary shape.
+    bool open(const void *data, size_t length);
+    /// Returns the size of the binary shape in bytes. Multiple binary shapes may be stored back to back.
+    size_t size() const;
+    /// Returns the number of contours.
+    int contourCount() const;
+    /// Returns the total number of edge segments.
+    int edgeCount() const;
+    /// Returns the number of edge segments of the specified contour.
+    int contourEdgeCount(int contourIndex) const;
+    /// Returns the orientation of the axis of the shape's Y coordinates.
+    YAxisOrientation getYAxisOrientation() const;
+    /// Returns whether the edge colors were assigned when the shape was serialized.
+    bool colorsSpecified() const;
+    /// Outputs the bounds of the shape if they were precomputed during serialization, returns false if they weren't.
+    bool getBounds(Shape::Bounds &bounds) const;
+    /// Reconstructs the specified contour.
+    void getContour(int contourIndex, Contour &output) const;
+    /// Reconstructs the whole shape.
+    void getShape(Shape &output) const;
+
+private:
+    const byte *header;
+    const byte *points;
+    const byte *contourEnds;
+    const byte *edgeDescriptors;
+    size_t totalSize;
+    int nContours, nEdges, flags;
+
+    int contourStart(int contourIndex) const;
+
+};
+
+/// Serializes a shape into the binary shape format, appending it to the output buffer.
+bool writeShapeBinary(std::vector<byte> &output, const Shape &shape, bool includeBounds = false);
+/// Serializes a shape into the binary shape format.
+bool writeShapeBinary(FILE *output, const Shape &shape, bool includeBounds = false);
+/// Deserializes a shape from the binary shape format.
+bool readShapeBinary(const void *data, size_t length, Shape &output, bool *colorsSpecified = NULL);
+/// Deserializes the next shape in the binary shape format from a file.
+bool readShapeBinary(FILE *input, Shape &output, bool *colorsSpecified = NULL);
+
+}
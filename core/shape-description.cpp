@@ -6,57 +6,48 @@
 #include "shape-description.h"
 
 #include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "parse-number.h"
 
 namespace msdfgen {
 
-int readCharF(FILE *input) {
-    int c = '\0';
-    do {
-        c = fgetc(input);
-    } while (c == ' ' || c == '\t' || c == '\r' || c == '\n');
-    return c;
-}
+struct DescriptionBuffer {
+    const char *cur, *end;
+};
 
-int readCharS(const char **input) {
-    int c = '\0';
-    do {
-        c = *(*input)++;
-    } while (c == ' ' || c == '\t' || c == '\r' || c == '\n');
-    if (!c) {
-        --c;
-        return EOF;
-    }
-    return c;
+static void skipWhitespace(DescriptionBuffer *input) {
+    while (input->cur < input->end && (*input->cur == ' ' || *input->cur == '\t' || *input->cur == '\r' || *input->cur == '\n'))
+        ++input->cur;
 }
 
-int readCoordF(FILE *input, Point2 &coord) {
-    return fscanf(input, "%lf , %lf", &coord.x, &coord.y);
+static int readChar(DescriptionBuffer *input) {
+    skipWhitespace(input);
+    if (input->cur < input->end)
+        return *input->cur++;
+    return EOF;
 }
 
-int readCoordS(const char **input, Point2 &coord) {
-    char *end = NULL;
-    coord.x = strtod(*input, &end);
-    if (end <= *input)
+static int readCoord(DescriptionBuffer *input, Point2 &coord) {
+    skipWhitespace(input);
+    if (!parseNumber(coord.x, input->cur, input->end))
         return 0;
-    *input = end;
-    while (**input == ' ' || **input == '\t' || **input == '\n' || **input == '\r')
-        ++*input;
-    if (**input != ',')
+    skipWhitespace(input);
+    if (!(input->cur < input->end && *input->cur == ','))
         return 1;
-    ++*input;
-    coord.y = strtod(*input, &end);
-    if (end <= *input)
+    ++input->cur;
+    skipWhitespace(input);
+    if (!parseNumber(coord.y, input->cur, input->end))
         return 1;
-    *input = end;
     return 2;
 }
 
-bool matchStringS(const char **input, const char *str) {
-    const char *cur = *input;
-    while (*cur && *str && *cur == *str)
+static bool matchString(DescriptionBuffer *input, const char *str) {
+    const char *cur = input->cur;
+    while (cur < input->end && *str && *cur == *str)
         ++cur, ++str;
     if (!*str) {
-        *input = cur;
+        input->cur = cur;
         return true;
     }
     return false;
@@ -185,72 +176,45 @@ static bool readContour(T *input, Contour &output, const Point2 *first, int term
 }
 
 bool readShapeDescription(FILE *input, Shape &output, bool *colorsSpecified) {
-    bool locColorsSpec = false;
-    output.contours.clear();
-    output.setYAxisOrientation(MSDFGEN_Y_AXIS_DEFAULT_ORIENTATION);
-    Point2 p;
-    int result = readCoordF(input, p);
-    if (result == 2) {
-        return readContour<FILE, readCharF, readCoordF>(input, output.addContour(), &p, EOF, locColorsSpec);
-    } else if (result == 1)
+    std::vector<char> buffer;
+    char chunk[4096];
+    for (size_t chunkLength; (chunkLength = fread(chunk, 1, sizeof(chunk), input));)
+        buffer.insert(buffer.end(), chunk, chunk+chunkLength);
+    if (ferror(input))
         return false;
-    else {
-        int c = readCharF(input);
-        if (c == '@') {
-            char after = '\0';
-            if (fscanf(input, "y-%c", &after) == 1 && (after == 'u' || after == 'd')) {
-                switch (after) {
-                    case 'u':
-                        output.setYAxisOrientation(Y_UPWARD);
-                        break;
-                    case 'd':
-                        output.setYAxisOrientation(Y_DOWNWARD);
-                        break;
-                }
-                if (fscanf(input, after == 'u' ? "p%c" : "own%c", &after) != 1)
-                    return feof(input) != 0;
-            } else if (fscanf(input, "invert-y%c", &after) == 1)
-                output.inverseYAxis = true;
-            else
-                return feof(input) != 0;
-            c = after;
-            if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
-                c = readCharF(input);
-        }
-        for (; c == '{'; c = readCharF(input))
-            if (!readContour<FILE, readCharF, readCoordF>(input, output.addContour(), NULL, '}', locColorsSpec))
-                return false;
-        if (colorsSpecified)
-            *colorsSpecified = locColorsSpec;
-        return c == EOF && feof(input);
-    }
+    return readShapeDescription(buffer.empty() ? NULL : &buffer[0], buffer.size(), output, colorsSpecified);
 }
 
 bool readShapeDescription(const char *input, Shape &output, bool *colorsSpecified) {
+    return readShapeDescription(input, strlen(input), output, colorsSpecified);
+}
+
+bool readShapeDescription(const char *input, size_t length, Shape &output, bool *colorsSpecified) {
+    DescriptionBuffer buffer = { input, input+length };
     bool locColorsSpec = false;
     output.contours.clear();
     output.setYAxisOrientation(MSDFGEN_Y_AXIS_DEFAULT_ORIENTATION);
     Point2 p;
-    int result = readCoordS(&input, p);
+    int result = readCoord(&buffer, p);
     if (result == 2) {
-        return readContour<const char *, readCharS, readCoordS>(&input, output.addContour(), &p, EOF, locColorsSpec);
+        return readContour<DescriptionBuffer, readChar, readCoord>(&buffer, output.addContour(), &p, EOF, locColorsSpec);
     } else if (result == 1)
         return false;
     else {
-        int c = readCharS(&input);
+        int c = readChar(&buffer);
         if (c == '@') {
-            if (matchStringS(&input, "y-down"))
+            if (matchString(&buffer, "y-down"))
                 output.setYAxisOrientation(Y_DOWNWARD);
-            else if (matchStringS(&input, "y-up"))
+            else if (matchString(&buffer, "y-up"))
                 output.setYAxisOrientation(Y_UPWARD);
-            else if (matchStringS(&input, "invert-y"))
+            else if (matchString(&buffer, "invert-y"))
                 output.inverseYAxis = true;
             else
                 return false;
-            c = readCharS(&input);
+            c = readChar(&buffer);
         }
-        for (; c == '{'; c = readCharS(&input))
-            if (!readContour<const char *, readCharS, readCoordS>(&input, output.addContour(), NULL, '}', locColorsSpec))
+        for (; c == '{'; c = readChar(&buffer))
+            if (!readContour<DescriptionBuffer, readChar, readCoord>(&buffer, output.addContour(), NULL, '}', locColorsSpec))
                 return false;
         if (colorsSpecified)
             *colorsSpecified = locColorsSpec;
@@ -258,6 +222,22 @@ bool readShapeDescription(const char *input, Shape &output, bool *colorsSpecifie
     }
 }
 
+bool readNextShapeDescription(const char *&input, const char *end, Shape &output, bool *colorsSpecified) {
+    DescriptionBuffer buffer = { input, end };
+    skipWhitespace(&buffer);
+    if (buffer.cur >= end) {
+        input = end;
+        return false;
+    }
+    // The description extends until the next @ directive, which begins the following description
+    const char *next = buffer.cur+1;
+    while (next < end && *next != '@')
+        ++next;
+    // Input is advanced even if the description is invalid, so that it can be skipped
+    input = next;
+    return readShapeDescription(buffer.cur, next-buffer.cur, output, colorsSpecified);
+}
+
 static bool isColored(const Shape &shape) {
     for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour)
         for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge)
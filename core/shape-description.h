@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdio>
 #include "Shape.h"
 
@@ -9,6 +10,10 @@ namespace msdfgen {
 /// Deserializes a text description of a vector shape into output.
 bool readShapeDescription(FILE *input, Shape &output, bool *colorsSpecified = NULL);
 bool readShapeDescription(const char *input, Shape &output, bool *colorsSpecified = NULL);
+bool readShapeDescription(const char *input, size_t length, Shape &output, bool *colorsSpecified = NULL);
+/// Deserializes the next of multiple concatenated text descriptions, each beginning with an @ directive (as written by writeShapeDescription), and advances input past it.
+/// Returns false if there are no more descriptions, in which case input is set to end, or if the description is invalid, in which case input is still advanced past it.
+bool readNextShapeDescription(const char *&input, const char *end, Shape &output, bool *colorsSpecified = NULL);
 /// Serializes a shape object into a text description.
 bool writeShapeDescription(FILE *output, const Shape &shape);
 
@@ -0,0 +1,59 @@
+
+#include "shape-flattening.h"
+
+#include <vector>
+#include "arithmetics.hpp"
+
+// Maximum depth of recursive curve subdivision, limits the number of line segments per edge to 2^depth
+#define FLATTENING_MAX_DEPTH 16
+
+namespace msdfgen {
+
+static void flattenQuadratic(std::vector<EdgeHolder> &output, Point2 p0, Point2 p1, Point2 p2, EdgeColor color, double tolerance, int depth) {
+    // Maximum distance between the curve and its chord at the same parameter value
+    if (depth >= FLATTENING_MAX_DEPTH || .25*(p0-2*p1+p2).length() <= tolerance) {
+        output.push_back(EdgeHolder(p0, p2, color));
+        return;
+    }
+    Point2 p01 = mix(p0, p1, .5), p12 = mix(p1, p2, .5);
+    Point2 mid = mix(p01, p12, .5);
+    flattenQuadratic(output, p0, p01, mid, color, tolerance, depth+1);
+    flattenQuadratic(output, mid, p12, p2, color, tolerance, depth+1);
+}
+
+static void flattenCubic(std::vector<EdgeHolder> &output, Point2 p0, Point2 p1, Point2 p2, Point2 p3, EdgeColor color, double tolerance, int depth) {
+    // The difference between the curve and its uniformly parametrized chord is a cubic Bezier curve with control points 0, d1, d2, 0
+    Vector2 d1 = p1-(1./3)*(2*p0+p3), d2 = p2-(1./3)*(p0+2*p3);
+    if (depth >= FLATTENING_MAX_DEPTH || .75*max(d1.length(), d2.length()) <= tolerance) {
+        output.push_back(EdgeHolder(p0, p3, color));
+        return;
+    }
+    Point2 p01 = mix(p0, p1, .5), p12 = mix(p1, p2, .5), p23 = mix(p2, p3, .5);
+    Point2 p012 = mix(p01, p12, .5), p123 = mix(p12, p23, .5);
+    Point2 mid = mix(p012, p123, .5);
+    flattenCubic(output, p0, p01, p012, mid, color, tolerance, depth+1);
+    flattenCubic(output, mid, p123, p23, p3, color, tolerance, depth+1);
+}
+
+void flattenShape(Shape &shape, double tolerance) {
+    for (std::vector<Contour>::iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
+        std::vector<EdgeHolder> edges;
+        edges.reserve(contour->edges.size());
+        for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+            const Point2 *p = (*edge)->controlPoints();
+            switch ((*edge)->type()) {
+                case (int) QuadraticSegment::EDGE_TYPE:
+                    flattenQuadratic(edges, p[0], p[1], p[2], (*edge)->color, tolerance, 0);
+                    break;
+                case (int) CubicSegment::EDGE_TYPE:
+                    flattenCubic(edges, p[0], p[1], p[2], p[3], (*edge)->color, tolerance, 0);
+                    break;
+                default:
+                    edges.push_back(*edge);
+            }
+        }
+        contour->edges.swap(edges);
+    }
+}
+
+}
@@ -0,0 +1,11 @@
+
+#pragma once
+
+#include "Shape.h"
+
+namespace msdfgen {
+
+/// Approximates all curved edges of the shape by line segments which deviate from the original curves by at most tolerance (in shape units). The resulting segments inherit the color of their edge so that an existing edge coloring remains valid.
+void flattenShape(Shape &shape, double tolerance);
+
+}
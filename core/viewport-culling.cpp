@@ -0,0 +1,238 @@
+
+#include "viewport-culling.h"
+
+#include <cstdlib>
+#include <cmath>
+#include <cfloat>
+#include <vector>
+#include <algorithm>
+#include "arithmetics.hpp"
+
+namespace msdfgen {
+
+static bool isOutside(const Shape::Bounds &bounds, const Shape::Bounds &area) {
+    return bounds.l > area.r || bounds.r < area.l || bounds.b > area.t || bounds.t < area.b;
+}
+
+static Shape::Bounds expandBounds(const Shape::Bounds &bounds, double margin) {
+    Shape::Bounds expanded = { bounds.l-margin, bounds.b-margin, bounds.r+margin, bounds.t+margin };
+    return expanded;
+}
+
+/// Returns the greatest distance between p and any point of the viewport.
+static double farthestViewportDistance(const Point2 &p, const Shape::Bounds &viewport) {
+    return Vector2(max(fabs(p.x-viewport.l), fabs(p.x-viewport.r)), max(fabs(p.y-viewport.b), fabs(p.y-viewport.t))).length();
+}
+
+static Point2 clampToArea(const Point2 &p, const Shape::Bounds &area) {
+    return Point2(clamp(p.x, area.l, area.r), clamp(p.y, area.b, area.t));
+}
+
+static double signedArea(const Contour &contour) {
+    double total = 0;
+    Point2 prev = contour.edges.back()->point(0);
+    for (std::vector<EdgeHolder>::const_iterator edge = contour.edges.begin(); edge != contour.edges.end(); ++edge) {
+        Point2 cur = (*edge)->point(0);
+        total += crossProduct(prev, cur);
+        prev = cur;
+    }
+    return .5*total;
+}
+
+static Point2 nearestCorner(const Point2 &p, const Shape::Bounds &area) {
+    return Point2(p.x-area.l < area.r-p.x ? area.l : area.r, p.y-area.b < area.t-p.y ? area.b : area.t);
+}
+
+/// For p outside the area, returns where an axis-aligned path from p to corner must turn so that the extensions of its lines never enter the area.
+static Point2 cornerPathTurn(const Point2 &p, const Point2 &corner, const Shape::Bounds &area) {
+    if (p.x < area.l || p.x > area.r)
+        return Point2(p.x, corner.y);
+    return Point2(corner.x, p.y);
+}
+
+static void addLinearPath(Contour &contour, const Point2 &a, const Point2 &b, const Point2 &c) {
+    if (a != b)
+        contour.addEdge(EdgeHolder(a, b, BLACK));
+    if (b != c)
+        contour.addEdge(EdgeHolder(b, c, BLACK));
+}
+
+static bool isOnCommonSide(const Point2 &a, const Point2 &b, const Point2 &c, const Shape::Bounds &area) {
+    return (
+        (a.x == area.l && b.x == area.l && c.x == area.l) ||
+        (a.x == area.r && b.x == area.r && c.x == area.r) ||
+        (a.y == area.b && b.y == area.b && c.y == area.b) ||
+        (a.y == area.t && b.y == area.t && c.y == area.t)
+    );
+}
+
+/// Appends a point on the area's boundary to a path running along the boundary, eliminating any back-and-forth movement along a single side.
+static void appendBoundaryPoint(std::vector<Point2> &path, const Point2 &p, const Shape::Bounds &area) {
+    if (!path.empty() && path.back() == p)
+        return;
+    if (path.size() >= 2 && isOnCommonSide(path[path.size()-2], path.back(), p, area)) {
+        path.back() = p;
+        if (path[path.size()-2] == p)
+            path.pop_back();
+        return;
+    }
+    path.push_back(p);
+}
+
+/// Returns how many times a closed path running along the area's boundary winds around it.
+static int boundaryPathWinding(const std::vector<Point2> &path, const Shape::Bounds &area) {
+    double y = .5*(area.b+area.t);
+    int winding = 0;
+    for (size_t i = 0; i+1 < path.size(); ++i) {
+        const Point2 &a = path[i], &b = path[i+1];
+        if (a.x == area.r && b.x == area.r && (a.y <= y) != (b.y <= y))
+            winding += b.y > a.y ? 1 : -1;
+    }
+    return winding;
+}
+
+bool cullShape(Shape &output, const Shape &shape, const Shape::Bounds &viewport, double range) {
+    if (!(range >= 0 && range < DBL_MAX && viewport.l <= viewport.r && viewport.b <= viewport.t))
+        return false;
+
+    // No point of the viewport is farther than nearRange from the nearest edge, and the same holds for the range of each contour,
+    // so retaining everything within these ranges keeps all distances exact and the substitute edges can never be the nearest ones
+    std::vector<Shape::Bounds> edgeBounds;
+    std::vector<double> contourRanges;
+    edgeBounds.reserve(shape.edgeCount());
+    contourRanges.reserve(shape.contours.size());
+    double nearRange = DBL_MAX;
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
+        double contourRange = DBL_MAX;
+        for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+            Shape::Bounds bounds = { DBL_MAX, DBL_MAX, -DBL_MAX, -DBL_MAX };
+            (*edge)->bound(bounds.l, bounds.b, bounds.r, bounds.t);
+            edgeBounds.push_back(bounds);
+            contourRange = min(contourRange, farthestViewportDistance((*edge)->point(0), viewport));
+        }
+        nearRange = min(nearRange, contourRange);
+        contourRanges.push_back(contourRange);
+    }
+    if (nearRange < DBL_MAX)
+        range = max(range, nearRange);
+    // Any edge nearer than range to a point of the viewport must have its bounding box intersect this area
+    Shape::Bounds area = expandBounds(viewport, range);
+    if (!(area.l < area.r && area.b < area.t && area.l > -DBL_MAX && area.r < DBL_MAX && area.b > -DBL_MAX && area.t < DBL_MAX))
+        return false;
+
+    // Contours which do not reach into the area are culled entirely, the rest are reduced to the edges within their own range
+    std::vector<char> outside(edgeBounds.size(), true);
+    std::vector<Shape::Bounds> contourAreas(shape.contours.size(), area);
+    bool anyOutside = false;
+    for (int i = 0, edgeIndex = 0; i < (int) shape.contours.size(); edgeIndex += (int) shape.contours[i++].edges.size()) {
+        int n = (int) shape.contours[i].edges.size();
+        bool touching = false;
+        for (int j = 0; j < n && !touching; ++j)
+            touching = !isOutside(edgeBounds[edgeIndex+j], area);
+        if (!touching) {
+            anyOutside |= n > 0;
+            continue;
+        }
+        contourAreas[i] = expandBounds(viewport, max(range, contourRanges[i]));
+        for (int j = 0; j < n; ++j)
+            anyOutside |= outside[edgeIndex+j] = isOutside(edgeBounds[edgeIndex+j], contourAreas[i]);
+    }
+    if (!anyOutside)
+        return false;
+
+    output.contours.clear();
+    output.setYAxisOrientation(shape.getYAxisOrientation());
+    std::vector<char> retained;
+    std::vector<Point2> path;
+    int enclosingWinding = 0;
+    const char *contourOutside = &outside[0];
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); contourOutside += contour->edges.size(), ++contour) {
+        int n = (int) contour->edges.size();
+        const Shape::Bounds &contourArea = contourAreas[contour-shape.contours.begin()];
+        // Edges adjacent to those inside the area are retained as well so that the pseudo-distance domains of the latter remain unchanged
+        retained.resize(n);
+        int retainedCount = 0;
+        for (int i = 0; i < n; ++i)
+            retainedCount += retained[i] = !contourOutside[(i+n-1)%n] || !contourOutside[i] || !contourOutside[(i+1)%n];
+        if (retainedCount == n) {
+            output.addContour(*contour);
+            continue;
+        }
+
+        if (!retainedCount) {
+            // A contour that lies entirely outside only matters if it winds around the area
+            path.clear();
+            for (int i = 0; i < n; ++i)
+                appendBoundaryPoint(path, clampToArea(contour->edges[i]->point(0), area), area);
+            appendBoundaryPoint(path, clampToArea(contour->edges[0]->point(0), area), area);
+            enclosingWinding += boundaryPathWinding(path, area);
+            continue;
+        }
+
+        // Start at the beginning of a retained sequence of edges
+        int start = 0;
+        while (!(retained[start] && !retained[(start+n-1)%n]))
+            ++start;
+        Contour &culledContour = output.addContour();
+        int anchor = -1;
+        Point2 anchorCorner;
+        for (int i = 0; i < n;) {
+            int index = (start+i)%n;
+            if (retained[index]) {
+                culledContour.addEdge(contour->edges[index]);
+                ++i;
+                continue;
+            }
+            // Substitute the culled sequence of edges with its projection onto the area's boundary, which is homotopic to it outside the area,
+            // and connect it to the retained edges via the nearest corners, so that no substitute edge points into the area
+            Point2 first = contour->edges[index]->point(0), last;
+            Point2 firstCorner = nearestCorner(first, contourArea);
+            path.clear();
+            path.push_back(firstCorner);
+            appendBoundaryPoint(path, clampToArea(first, contourArea), contourArea);
+            for (; i < n && !retained[index = (start+i)%n]; ++i) {
+                last = contour->edges[index]->point(1);
+                appendBoundaryPoint(path, clampToArea(last, contourArea), contourArea);
+            }
+            Point2 lastCorner = nearestCorner(last, contourArea);
+            appendBoundaryPoint(path, lastCorner, contourArea);
+            addLinearPath(culledContour, first, cornerPathTurn(first, firstCorner, contourArea), firstCorner);
+            if (anchor < 0) {
+                anchor = (int) culledContour.edges.size();
+                anchorCorner = firstCorner;
+            }
+            for (size_t j = 0; j+1 < path.size(); ++j)
+                culledContour.addEdge(EdgeHolder(path[j], path[j+1], BLACK));
+            addLinearPath(culledContour, lastCorner, cornerPathTurn(last, lastCorner, contourArea), last);
+        }
+        // The substitute edges may change the contour's orientation, which is restored by a loop at one of the corners
+        int winding = contour->winding();
+        if (winding && culledContour.winding() != winding) {
+            double loopSize = sqrt(2*fabs(signedArea(culledContour)))+(contourArea.r-contourArea.l);
+            Point2 loop[4];
+            loop[0] = anchorCorner;
+            loop[1] = anchorCorner+Vector2(anchorCorner.x == contourArea.l ? -loopSize : loopSize, 0);
+            loop[3] = anchorCorner+Vector2(0, anchorCorner.y == contourArea.b ? -loopSize : loopSize);
+            loop[2] = Point2(loop[1].x, loop[3].y);
+            if ((crossProduct(loop[1]-loop[0], loop[3]-loop[0]) < 0) != (winding > 0))
+                std::swap(loop[1], loop[3]);
+            EdgeHolder loopEdges[4] = { EdgeHolder(loop[0], loop[1], BLACK), EdgeHolder(loop[1], loop[2], BLACK), EdgeHolder(loop[2], loop[3], BLACK), EdgeHolder(loop[3], loop[0], BLACK) };
+            culledContour.edges.insert(culledContour.edges.begin()+anchor, loopEdges, loopEdges+4);
+        }
+    }
+
+    // Contours enclosing the area are merged into a single one running along its boundary
+    if (enclosingWinding) {
+        Point2 corners[4] = { Point2(area.l, area.b), Point2(area.r, area.b), Point2(area.r, area.t), Point2(area.l, area.t) };
+        Contour &enclosingContour = output.addContour();
+        for (int i = 0; i < 4*abs(enclosingWinding); ++i) {
+            if (enclosingWinding > 0)
+                enclosingContour.addEdge(EdgeHolder(corners[i%4], corners[(i+1)%4], BLACK));
+            else
+                enclosingContour.addEdge(EdgeHolder(corners[(4-i%4)%4], corners[(7-i%4)%4], BLACK));
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,20 @@
+
+#pragma once
+
+#include "Shape.h"
+
+namespace msdfgen {
+
+/**
+ * Reduces shape to the edges which may affect its signed distance within the viewport rectangle,
+ * which are those within range of it and those that may be the nearest edge of their contour for a point of the viewport.
+ * Culled portions of contours are replaced by straight lines running farther away, which keep the contours closed
+ * and preserve their orientation as well as the winding of every point within the viewport.
+ * Only the true signed distance to the nearest edge of the whole shape is preserved. The pseudo-distance of a culled edge's extension
+ * may still reach into the viewport, and contours out of range are culled regardless of their own distance, so the output is not suitable
+ * for pseudo-distance or multi-channel generators, nor for the overlapping contour combiner. Substitute edges are BLACK.
+ * Returns false and leaves output untouched if no edges can be culled.
+ */
+bool cullShape(Shape &output, const Shape &shape, const Shape::Bounds &viewport, double range);
+
+}
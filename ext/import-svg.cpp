@@ -32,6 +32,7 @@
 #endif
 
 #include "../core/arithmetics.hpp"
+#include "../core/parse-number.h"
 
 #define ARC_SEGMENTS_PER_PI 2
 #define ENDPOINT_SNAP_RANGE_PROPORTION (1/16384.)
@@ -58,17 +59,6 @@ static void skipExtraChars(const char *&pathDef) {
         ++pathDef;
 }
 
-static bool readNodeType(char &output, const char *&pathDef) {
-    skipExtraChars(pathDef);
-    char nodeType = *pathDef;
-    if (nodeType && nodeType != '+' && nodeType != '-' && nodeType != '.' && nodeType != ',' && (nodeType < '0' || nodeType > '9')) {
-        ++pathDef;
-        output = nodeType;
-        return true;
-    }
-    return false;
-}
-
 static bool readDouble(double &output, const char *&pathDef) {
     skipExtraChars(pathDef);
     char *end = NULL;
@@ -84,18 +74,107 @@ static bool readCoord(Point2 &output, const char *&pathDef) {
     return readDouble(output.x, pathDef) && readDouble(output.y, pathDef);
 }
 
-static bool readBool(bool &output, const char *&pathDef) {
-    skipExtraChars(pathDef);
-    char *end = NULL;
-    long v = strtol(pathDef, &end, 10);
-    if (end > pathDef) {
-        pathDef = end;
-        output = v != 0;
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static void skipExtraChars(const char *&cur, const char *end) {
+    while (cur < end && (*cur == ',' || *cur == ' ' || *cur == '\t' || *cur == '\r' || *cur == '\n'))
+        ++cur;
+}
+
+static bool readNodeType(char &output, const char *&cur, const char *end) {
+    skipExtraChars(cur, end);
+    if (cur < end) {
+        char nodeType = *cur;
+        if (nodeType && nodeType != '+' && nodeType != '-' && nodeType != '.' && nodeType != ',' && !isDigit(nodeType)) {
+            ++cur;
+            output = nodeType;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool readDouble(double &output, const char *&cur, const char *end) {
+    skipExtraChars(cur, end);
+    return parseNumber(output, cur, end);
+}
+
+static bool readCoord(Point2 &output, const char *&cur, const char *end) {
+    return readDouble(output.x, cur, end) && readDouble(output.y, cur, end);
+}
+
+static bool readBool(bool &output, const char *&cur, const char *end) {
+    // Arc flags are single characters and may not be separated from the following number
+    skipExtraChars(cur, end);
+    if (cur < end && (*cur == '0' || *cur == '1')) {
+        output = *cur++ == '1';
         return true;
     }
     return false;
 }
 
+static size_t countContours(const char *cur, const char *end) {
+    size_t contourCount = 0;
+    for (; cur < end; ++cur)
+        contourCount += *cur == 'M' || *cur == 'm';
+    return contourCount;
+}
+
+/// Estimates the number of edges of a contour whose definition starts at cur (after its initial moveto command) by counting commands and their arguments.
+static size_t estimateContourEdgeCount(const char *cur, const char *end) {
+    size_t edgeCount = 0, argCount = 0;
+    int argsPerCommand = 2, edgesPerCommand = 1;
+    bool number = false;
+    for (; cur < end; ++cur) {
+        char c = *cur;
+        if (isDigit(c) || c == '.' || ((c == '+' || c == '-') && !(cur[-1] == 'e' || cur[-1] == 'E'))) {
+            argCount += !number || c == '+' || c == '-';
+            number = true;
+        } else if (c == 'e' || c == 'E')
+            continue;
+        else {
+            number = false;
+            int nextArgsPerCommand;
+            switch (c) {
+                case 'M': case 'm':
+                    cur = end-1;
+                    // fallthrough
+                case 'Z': case 'z':
+                    nextArgsPerCommand = 0;
+                    break;
+                case 'L': case 'l': case 'T': case 't':
+                    nextArgsPerCommand = 2;
+                    break;
+                case 'H': case 'h': case 'V': case 'v':
+                    nextArgsPerCommand = 1;
+                    break;
+                case 'Q': case 'q': case 'S': case 's':
+                    nextArgsPerCommand = 4;
+                    break;
+                case 'C': case 'c':
+                    nextArgsPerCommand = 6;
+                    break;
+                case 'A': case 'a':
+                    nextArgsPerCommand = 7;
+                    break;
+                default:
+                    continue;
+            }
+            if (argsPerCommand)
+                edgeCount += edgesPerCommand*((argCount+argsPerCommand-1)/argsPerCommand);
+            argCount = 0;
+            argsPerCommand = nextArgsPerCommand;
+            edgesPerCommand = c == 'A' || c == 'a' ? 2*ARC_SEGMENTS_PER_PI : 1;
+        }
+    }
+    if (argsPerCommand)
+        edgeCount += edgesPerCommand*((argCount+argsPerCommand-1)/argsPerCommand);
+    // The initial moveto coordinate is counted as an edge, which accounts for a possible closing edge
+    return edgeCount;
+}
+
 static double arcAngle(Vector2 u, Vector2 v) {
     return nonZeroSign(crossProduct(u, v))*acos(clamp(dotProduct(u, v)/(u.length()*v.length()), -1., +1.));
 }
@@ -154,28 +233,30 @@ static void addArcApproximate(Contour &contour, Point2 startPoint, Point2 endPoi
     }
 }
 
-bool buildShapeFromSvgPath(Shape &shape, const char *pathDef, double endpointSnapRange) {
+bool buildShapeFromSvgPathRange(Shape &shape, const char *pathDef, const char *pathDefEnd, double endpointSnapRange) {
+    shape.contours.reserve(shape.contours.size()+countContours(pathDef, pathDefEnd));
     char nodeType = '\0';
     char prevNodeType = '\0';
     Point2 prevNode(0, 0);
     bool nodeTypePreread = false;
-    while (nodeTypePreread || readNodeType(nodeType, pathDef)) {
+    while (nodeTypePreread || readNodeType(nodeType, pathDef, pathDefEnd)) {
         nodeTypePreread = false;
         Contour &contour = shape.addContour();
+        contour.edges.reserve(estimateContourEdgeCount(pathDef, pathDefEnd));
         bool contourStart = true;
 
         Point2 startPoint;
         Point2 controlPoint[2];
         Point2 node;
 
-        while (*pathDef) {
+        while (pathDef < pathDefEnd) {
             switch (nodeType) {
                 case 'M': case 'm':
                     if (!contourStart) {
                         nodeTypePreread = true;
                         goto NEXT_CONTOUR;
                     }
-                    REQUIRE(readCoord(node, pathDef));
+                    REQUIRE(readCoord(node, pathDef, pathDefEnd));
                     if (nodeType == 'm')
                         node += prevNode;
                     startPoint = node;
@@ -185,26 +266,26 @@ bool buildShapeFromSvgPath(Shape &shape, const char *pathDef, double endpointSna
                     REQUIRE(!contourStart);
                     goto NEXT_CONTOUR;
                 case 'L': case 'l':
-                    REQUIRE(readCoord(node, pathDef));
+                    REQUIRE(readCoord(node, pathDef, pathDefEnd));
                     if (nodeType == 'l')
                         node += prevNode;
                     contour.addEdge(EdgeHolder(prevNode, node));
                     break;
                 case 'H': case 'h':
-                    REQUIRE(readDouble(node.x, pathDef));
+                    REQUIRE(readDouble(node.x, pathDef, pathDefEnd));
                     if (nodeType == 'h')
                         node.x += prevNode.x;
                     contour.addEdge(EdgeHolder(prevNode, node));
                     break;
                 case 'V': case 'v':
-                    REQUIRE(readDouble(node.y, pathDef));
+                    REQUIRE(readDouble(node.y, pathDef, pathDefEnd));
                     if (nodeType == 'v')
                         node.y += prevNode.y;
                     contour.addEdge(EdgeHolder(prevNode, node));
                     break;
                 case 'Q': case 'q':
-                    REQUIRE(readCoord(controlPoint[0], pathDef));
-                    REQUIRE(readCoord(node, pathDef));
+                    REQUIRE(readCoord(controlPoint[0], pathDef, pathDefEnd));
+                    REQUIRE(readCoord(node, pathDef, pathDefEnd));
                     if (nodeType == 'q') {
                         controlPoint[0] += prevNode;
                         node += prevNode;
@@ -216,15 +297,15 @@ bool buildShapeFromSvgPath(Shape &shape, const char *pathDef, double endpointSna
                         controlPoint[0] = node+node-controlPoint[0];
                     else
                         controlPoint[0] = node;
-                    REQUIRE(readCoord(node, pathDef));
+                    REQUIRE(readCoord(node, pathDef, pathDefEnd));
                     if (nodeType == 't')
                         node += prevNode;
                     contour.addEdge(EdgeHolder(prevNode, controlPoint[0], node));
                     break;
                 case 'C': case 'c':
-                    REQUIRE(readCoord(controlPoint[0], pathDef));
-                    REQUIRE(readCoord(controlPoint[1], pathDef));
-                    REQUIRE(readCoord(node, pathDef));
+                    REQUIRE(readCoord(controlPoint[0], pathDef, pathDefEnd));
+                    REQUIRE(readCoord(controlPoint[1], pathDef, pathDefEnd));
+                    REQUIRE(readCoord(node, pathDef, pathDefEnd));
                     if (nodeType == 'c') {
                         controlPoint[0] += prevNode;
                         controlPoint[1] += prevNode;
@@ -237,8 +318,8 @@ bool buildShapeFromSvgPath(Shape &shape, const char *pathDef, double endpointSna
                         controlPoint[0] = node+node-controlPoint[1];
                     else
                         controlPoint[0] = node;
-                    REQUIRE(readCoord(controlPoint[1], pathDef));
-                    REQUIRE(readCoord(node, pathDef));
+                    REQUIRE(readCoord(controlPoint[1], pathDef, pathDefEnd));
+                    REQUIRE(readCoord(node, pathDef, pathDefEnd));
                     if (nodeType == 's') {
                         controlPoint[1] += prevNode;
                         node += prevNode;
@@ -251,11 +332,11 @@ bool buildShapeFromSvgPath(Shape &shape, const char *pathDef, double endpointSna
                         double angle;
                         bool largeArg;
                         bool sweep;
-                        REQUIRE(readCoord(radius, pathDef));
-                        REQUIRE(readDouble(angle, pathDef));
-                        REQUIRE(readBool(largeArg, pathDef));
-                        REQUIRE(readBool(sweep, pathDef));
-                        REQUIRE(readCoord(node, pathDef));
+                        REQUIRE(readCoord(radius, pathDef, pathDefEnd));
+                        REQUIRE(readDouble(angle, pathDef, pathDefEnd));
+                        REQUIRE(readBool(largeArg, pathDef, pathDefEnd));
+                        REQUIRE(readBool(sweep, pathDef, pathDefEnd));
+                        REQUIRE(readCoord(node, pathDef, pathDefEnd));
                         if (nodeType == 'a')
                             node += prevNode;
                         angle *= M_PI/180.0;
@@ -268,7 +349,7 @@ bool buildShapeFromSvgPath(Shape &shape, const char *pathDef, double endpointSna
             contourStart &= nodeType == 'M' || nodeType == 'm';
             prevNode = node;
             prevNodeType = nodeType;
-            readNodeType(nodeType, pathDef);
+            readNodeType(nodeType, pathDef, pathDefEnd);
         }
     NEXT_CONTOUR:
         // Fix contour if it isn't properly closed
@@ -284,6 +365,127 @@ bool buildShapeFromSvgPath(Shape &shape, const char *pathDef, double endpointSna
     return true;
 }
 
+bool buildShapeFromSvgPath(Shape &shape, const char *pathDef, double endpointSnapRange) {
+    return buildShapeFromSvgPathRange(shape, pathDef, pathDef+strlen(pathDef), endpointSnapRange);
+}
+
+static bool readAffineTransformationOp(double dst[6], int &count, const char *&str, const char *name) {
+    int nameLen = int(strlen(name));
+    if (!memcmp(str, name, nameLen)) {
+        const char *curStr = str+nameLen;
+        skipExtraChars(curStr);
+        if (*curStr == '(') {
+            skipExtraChars(++curStr);
+            count = 0;
+            while (*curStr && *curStr != ')') {
+                if (!(count < 6 && readDouble(dst[count], curStr)))
+                    return false;
+                ++count;
+                skipExtraChars(curStr);
+            }
+            if (*curStr == ')') {
+                str = curStr+1;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void setAffineTransformation(double dst[6], double a, double b, double c, double d, double e, double f) {
+    dst[0] = a, dst[1] = b, dst[2] = c, dst[3] = d, dst[4] = e, dst[5] = f;
+}
+
+static void multiplyAffineTransformations(double dst[6], const double a[6], const double b[6]) {
+    double product[6];
+    product[0] = a[0]*b[0]+a[2]*b[1];
+    product[1] = a[1]*b[0]+a[3]*b[1];
+    product[2] = a[0]*b[2]+a[2]*b[3];
+    product[3] = a[1]*b[2]+a[3]*b[3];
+    product[4] = a[0]*b[4]+a[2]*b[5]+a[4];
+    product[5] = a[1]*b[4]+a[3]*b[5]+a[5];
+    memcpy(dst, product, sizeof(product));
+}
+
+static void parseAffineTransformation(double dst[6], int &flags, const char *str) {
+    setAffineTransformation(dst, 1, 0, 0, 1, 0, 0);
+    skipExtraChars(str);
+    while (*str) {
+        double values[6];
+        int count;
+        double partial[6];
+        if (readAffineTransformationOp(values, count, str, "matrix") && count == 6) {
+            memcpy(partial, values, sizeof(partial));
+        } else if (readAffineTransformationOp(values, count, str, "translate") && (count == 1 || count == 2)) {
+            setAffineTransformation(partial, 1, 0, 0, 1, values[0], count == 2 ? values[1] : 0);
+        } else if (readAffineTransformationOp(values, count, str, "scale") && (count == 1 || count == 2)) {
+            setAffineTransformation(partial, values[0], 0, 0, count == 2 ? values[1] : values[0], 0, 0);
+        } else if (readAffineTransformationOp(values, count, str, "rotate") && (count == 1 || count == 3)) {
+            double c = cos(M_PI/180*values[0]), s = sin(M_PI/180*values[0]);
+            if (count == 3)
+                setAffineTransformation(partial, c, s, -s, c, values[1]-c*values[1]+s*values[2], values[2]-s*values[1]-c*values[2]);
+            else
+                setAffineTransformation(partial, c, s, -s, c, 0, 0);
+        } else if (readAffineTransformationOp(values, count, str, "skewX") && count == 1) {
+            setAffineTransformation(partial, 1, 0, tan(M_PI/180*values[0]), 1, 0, 0);
+        } else if (readAffineTransformationOp(values, count, str, "skewY") && count == 1) {
+            setAffineTransformation(partial, 1, tan(M_PI/180*values[0]), 0, 1, 0, 0);
+        } else {
+            flags |= SVG_IMPORT_PARTIAL_FAILURE_FLAG;
+            break;
+        }
+        multiplyAffineTransformations(dst, dst, partial);
+        skipExtraChars(str);
+    }
+}
+
+static void combineAffineTransformation(double dst[6], int &flags, const double parentTransformation[6], const char *transformationString, const char *transformationOriginString) {
+    if (transformationString && *transformationString) {
+        double transformation[6];
+        parseAffineTransformation(transformation, flags, transformationString);
+        if (transformationOriginString && *transformationOriginString) {
+            Point2 origin;
+            if (readCoord(origin, transformationOriginString)) {
+                double originTranslation[6];
+                setAffineTransformation(originTranslation, 1, 0, 0, 1, origin.x, origin.y);
+                multiplyAffineTransformations(transformation, originTranslation, transformation);
+                setAffineTransformation(originTranslation, 1, 0, 0, 1, -origin.x, -origin.y);
+                multiplyAffineTransformations(transformation, transformation, originTranslation);
+            } else
+                flags |= SVG_IMPORT_PARTIAL_FAILURE_FLAG;
+        }
+        multiplyAffineTransformations(dst, parentTransformation, transformation);
+    } else if (dst != parentTransformation)
+        memcpy(dst, parentTransformation, 6*sizeof(double));
+}
+
+static bool isIdentityTransformation(const double transformation[6]) {
+    return transformation[0] == 1 && transformation[1] == 0 && transformation[2] == 0 && transformation[3] == 1 && transformation[4] == 0 && transformation[5] == 0;
+}
+
+static Point2 transformPoint(const double transformation[6], Point2 point) {
+    return Point2(transformation[0]*point.x+transformation[2]*point.y+transformation[4], transformation[1]*point.x+transformation[3]*point.y+transformation[5]);
+}
+
+static void transformShape(Shape &shape, const double transformation[6]) {
+    for (std::vector<Contour>::iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
+        for (std::vector<EdgeHolder>::iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge) {
+            const Point2 *p = (*edge)->controlPoints();
+            switch ((*edge)->type()) {
+                case (int) LinearSegment::EDGE_TYPE:
+                    *edge = EdgeHolder(transformPoint(transformation, p[0]), transformPoint(transformation, p[1]), (*edge)->color);
+                    break;
+                case (int) QuadraticSegment::EDGE_TYPE:
+                    *edge = EdgeHolder(transformPoint(transformation, p[0]), transformPoint(transformation, p[1]), transformPoint(transformation, p[2]), (*edge)->color);
+                    break;
+                case (int) CubicSegment::EDGE_TYPE:
+                    *edge = EdgeHolder(transformPoint(transformation, p[0]), transformPoint(transformation, p[1]), transformPoint(transformation, p[2]), transformPoint(transformation, p[3]), (*edge)->color);
+                    break;
+            }
+        }
+    }
+}
+
 #ifdef MSDFGEN_USE_TINYXML2
 
 static void findPathByForwardIndex(tinyxml2::XMLElement *&path, int &flags, int &skips, tinyxml2::XMLElement *parent, bool hasTransformation) {
@@ -357,6 +559,63 @@ bool loadSvgShape(Shape &output, const char *filename, int pathIndex, Vector2 *d
     return buildShapeFromSvgPath(output, pd, ENDPOINT_SNAP_RANGE_PROPORTION*dims.length());
 }
 
+static void indexPaths(std::vector<SvgDocument::Path> &paths, int &flags, tinyxml2::XMLElement *parent, const double transformation[6]) {
+    for (tinyxml2::XMLElement *cur = parent->FirstChildElement(); cur; cur = cur->NextSiblingElement()) {
+        if (!strcmp(cur->Name(), "path")) {
+            paths.push_back(SvgDocument::Path());
+            SvgDocument::Path &path = paths.back();
+            path.flags = 0;
+            if (const char *id = cur->Attribute("id"))
+                path.id = id;
+            if (const char *pd = cur->Attribute("d"))
+                path.pathDef = pd;
+            else
+                path.flags |= SVG_IMPORT_PARTIAL_FAILURE_FLAG;
+            combineAffineTransformation(path.transformation, path.flags, transformation, cur->Attribute("transform"), cur->Attribute("transform-origin"));
+        } else if (!strcmp(cur->Name(), "g")) {
+            double groupTransformation[6];
+            combineAffineTransformation(groupTransformation, flags, transformation, cur->Attribute("transform"), cur->Attribute("transform-origin"));
+            indexPaths(paths, flags, cur, groupTransformation);
+        } else if (!strcmp(cur->Name(), "rect") || !strcmp(cur->Name(), "circle") || !strcmp(cur->Name(), "ellipse") || !strcmp(cur->Name(), "polygon"))
+            flags |= SVG_IMPORT_INCOMPLETE_FLAG;
+        else if (!strcmp(cur->Name(), "mask") || !strcmp(cur->Name(), "use"))
+            flags |= SVG_IMPORT_UNSUPPORTED_FEATURE_FLAG;
+    }
+}
+
+static bool indexSvgDocument(std::vector<SvgDocument::Path> &paths, Vector2 &dimensions, Shape::Bounds &viewBox, int &flags, tinyxml2::XMLDocument &doc) {
+    tinyxml2::XMLElement *root = doc.FirstChildElement("svg");
+    if (!root)
+        return false;
+    double identity[6];
+    setAffineTransformation(identity, 1, 0, 0, 1, 0, 0);
+    indexPaths(paths, flags, root, identity);
+
+    viewBox.l = 0, viewBox.b = 0;
+    dimensions.set(root->DoubleAttribute("width"), root->DoubleAttribute("height"));
+    if (const char *viewBoxStr = root->Attribute("viewBox"))
+        readDouble(viewBox.l, viewBoxStr) && readDouble(viewBox.b, viewBoxStr) && readDouble(dimensions.x, viewBoxStr) && readDouble(dimensions.y, viewBoxStr);
+    viewBox.r = viewBox.l+dimensions.x;
+    viewBox.t = viewBox.b+dimensions.y;
+    return true;
+}
+
+bool SvgDocument::load(const char *filename) {
+    *this = SvgDocument();
+    tinyxml2::XMLDocument doc;
+    if (doc.LoadFile(filename))
+        return false;
+    return indexSvgDocument(paths, dimensions, bounds, documentFlags, doc);
+}
+
+bool SvgDocument::parse(const char *svgData, size_t svgLength) {
+    *this = SvgDocument();
+    tinyxml2::XMLDocument doc;
+    if (doc.Parse(svgData, svgLength))
+        return false;
+    return indexSvgDocument(paths, dimensions, bounds, documentFlags, doc);
+}
+
 #endif
 
 #ifdef MSDFGEN_USE_DROPXML
@@ -397,6 +656,14 @@ static double xmlGetDouble(const char *start, const char *end) {
     return x;
 }
 
+static bool buildShapeFromXmlPath(Shape &shape, const char *start, const char *end, double endpointSnapRange) {
+    const char *decodedStart = start, *decodedEnd = end;
+    if (dropXML::decode(decodedStart, decodedEnd, nullptr, nullptr))
+        return buildShapeFromSvgPathRange(shape, decodedStart, decodedEnd, endpointSnapRange);
+    std::string decodedStr(xmlDecode(start, end));
+    return buildShapeFromSvgPathRange(shape, decodedStr.data(), decodedStr.data()+decodedStr.size(), endpointSnapRange);
+}
+
 #define SVG_NAME_IS(x) matchName(nameStart, nameEnd, x)
 #define SVG_DEC_VAL() xmlDecode(valueStart, valueEnd)
 #define SVG_DOUBLEVAL() xmlGetDouble(valueStart, valueEnd)
@@ -533,11 +800,211 @@ bool loadSvgShape(Shape &output, const char *filename, int pathIndex, Vector2 *d
         *dimensions = dims;
     output.contours.clear();
     output.setYAxisOrientation(Y_DOWNWARD);
-    return buildShapeFromSvgPath(output, xmlDecode(pathAggregator.pathDefs[pathIndex].start, pathAggregator.pathDefs[pathIndex].end).c_str(), ENDPOINT_SNAP_RANGE_PROPORTION*dims.length());
+    return buildShapeFromXmlPath(output, pathAggregator.pathDefs[pathIndex].start, pathAggregator.pathDefs[pathIndex].end, ENDPOINT_SNAP_RANGE_PROPORTION*dims.length());
+}
+
+class SvgPathIndexer : public BaseSvgConsumer {
+    enum {
+        IGNORED,
+        SVG,
+        G,
+        PATH
+    } curElement;
+    int ignoredDepth;
+    StrRange id, pathDef, transform, transformOrigin;
+    double transformation[6];
+    std::vector<double> transformationStack;
+
+public:
+    int flags;
+    Vector2 dimensions;
+    StrRange viewBox;
+    std::vector<SvgDocument::Path> paths;
+
+    inline SvgPathIndexer() : curElement(IGNORED), ignoredDepth(0), flags(0) {
+        setAffineTransformation(transformation, 1, 0, 0, 1, 0, 0);
+    }
+
+    inline bool enterElement(const char *nameStart, const char *nameEnd) {
+        curElement = IGNORED;
+        if (ignoredDepth)
+            ++ignoredDepth;
+        else if (SVG_NAME_IS("svg"))
+            curElement = SVG;
+        else if (SVG_NAME_IS("g"))
+            curElement = G;
+        else if (SVG_NAME_IS("path"))
+            curElement = PATH;
+        else {
+            if (SVG_NAME_IS("rect") || SVG_NAME_IS("circle") || SVG_NAME_IS("ellipse") || SVG_NAME_IS("polygon"))
+                flags |= SVG_IMPORT_INCOMPLETE_FLAG;
+            else if (SVG_NAME_IS("mask") || SVG_NAME_IS("use"))
+                flags |= SVG_IMPORT_UNSUPPORTED_FEATURE_FLAG;
+            ++ignoredDepth;
+        }
+        id = StrRange(), pathDef = StrRange(), transform = StrRange(), transformOrigin = StrRange();
+        return true;
+    }
+
+    inline bool leaveElement(const char *nameStart, const char *nameEnd) {
+        if (ignoredDepth) {
+            --ignoredDepth;
+            return true;
+        }
+        if (SVG_NAME_IS("g")) {
+            if (transformationStack.size() < 6)
+                return false;
+            memcpy(transformation, &transformationStack[transformationStack.size()-6], sizeof(transformation));
+            transformationStack.resize(transformationStack.size()-6);
+        }
+        return true;
+    }
+
+    inline bool elementAttribute(const char *nameStart, const char *nameEnd, const char *valueStart, const char *valueEnd) {
+        switch (curElement) {
+            case IGNORED:
+                break;
+            case SVG:
+                if (SVG_NAME_IS("width"))
+                    dimensions.x = SVG_DOUBLEVAL();
+                else if (SVG_NAME_IS("height"))
+                    dimensions.y = SVG_DOUBLEVAL();
+                else if (SVG_NAME_IS("viewBox"))
+                    viewBox = StrRange(valueStart, valueEnd);
+                break;
+            case PATH:
+                if (SVG_NAME_IS("d"))
+                    pathDef = StrRange(valueStart, valueEnd);
+                else if (SVG_NAME_IS("id"))
+                    id = StrRange(valueStart, valueEnd);
+                // fallthrough
+            case G:
+                if (SVG_NAME_IS("transform"))
+                    transform = StrRange(valueStart, valueEnd);
+                else if (SVG_NAME_IS("transform-origin"))
+                    transformOrigin = StrRange(valueStart, valueEnd);
+                break;
+        }
+        return true;
+    }
+
+    bool finishAttributes() {
+        switch (curElement) {
+            case IGNORED:
+            case SVG:
+                break;
+            case G:
+                transformationStack.insert(transformationStack.end(), transformation, transformation+6);
+                combineAffineTransformation(transformation, flags, transformation, xmlDecode(transform.start, transform.end).c_str(), xmlDecode(transformOrigin.start, transformOrigin.end).c_str());
+                break;
+            case PATH:
+                {
+                    paths.push_back(SvgDocument::Path());
+                    SvgDocument::Path &path = paths.back();
+                    path.flags = 0;
+                    path.id = xmlDecode(id.start, id.end);
+                    if (pathDef.start < pathDef.end)
+                        path.pathDef = xmlDecode(pathDef.start, pathDef.end);
+                    else
+                        path.flags |= SVG_IMPORT_PARTIAL_FAILURE_FLAG;
+                    combineAffineTransformation(path.transformation, path.flags, transformation, xmlDecode(transform.start, transform.end).c_str(), xmlDecode(transformOrigin.start, transformOrigin.end).c_str());
+                }
+                break;
+        }
+        return true;
+    }
+
+    inline bool finish() { return !ignoredDepth && transformationStack.empty(); }
+
+};
+
+bool SvgDocument::load(const char *filename) {
+    std::vector<char> svgData;
+    if (!(readFile(svgData, filename) && !svgData.empty())) {
+        *this = SvgDocument();
+        return false;
+    }
+    return parse(&svgData[0], svgData.size());
+}
+
+bool SvgDocument::parse(const char *svgData, size_t svgLength) {
+    *this = SvgDocument();
+    SvgPathIndexer pathIndexer;
+    if (!dropXML::parse(pathIndexer, svgData, svgData+svgLength))
+        return false;
+
+    paths.swap(pathIndexer.paths);
+    documentFlags = pathIndexer.flags;
+    dimensions = pathIndexer.dimensions;
+    bounds.l = 0, bounds.b = 0;
+    if (pathIndexer.viewBox.start < pathIndexer.viewBox.end) {
+        std::string viewBoxStr = xmlDecode(pathIndexer.viewBox.start, pathIndexer.viewBox.end);
+        const char *viewBoxPtr = viewBoxStr.c_str();
+        readDouble(bounds.l, viewBoxPtr) && readDouble(bounds.b, viewBoxPtr) && readDouble(dimensions.x, viewBoxPtr) && readDouble(dimensions.y, viewBoxPtr);
+    }
+    bounds.r = bounds.l+dimensions.x;
+    bounds.t = bounds.b+dimensions.y;
+    return true;
 }
 
 #endif
 
+SvgDocument::SvgDocument() : bounds(), documentFlags(0) { }
+
+int SvgDocument::pathCount() const {
+    return (int) paths.size();
+}
+
+const SvgDocument::Path &SvgDocument::path(int index) const {
+    return paths[index];
+}
+
+int SvgDocument::findPath(const char *id) const {
+    for (int i = 0; i < (int) paths.size(); ++i) {
+        if (paths[i].id == id)
+            return i;
+    }
+    return -1;
+}
+
+Shape::Bounds SvgDocument::viewBox() const {
+    return bounds;
+}
+
+int SvgDocument::flags() const {
+    return documentFlags;
+}
+
+int SvgDocument::buildShape(Shape &output, int pathIndex, bool applyTransformation) const {
+    output.contours.clear();
+    output.setYAxisOrientation(Y_DOWNWARD);
+    if (!(pathIndex >= 0 && pathIndex < (int) paths.size()))
+        return SVG_IMPORT_FAILURE;
+    const Path &path = paths[pathIndex];
+    if (!buildShapeFromSvgPath(output, path.pathDef.c_str(), ENDPOINT_SNAP_RANGE_PROPORTION*dimensions.length()))
+        return SVG_IMPORT_FAILURE;
+    int flags = SVG_IMPORT_SUCCESS_FLAG|path.flags;
+    if (!isIdentityTransformation(path.transformation)) {
+        if (applyTransformation)
+            transformShape(output, path.transformation);
+        else
+            flags |= SVG_IMPORT_TRANSFORMATION_IGNORED_FLAG;
+    }
+    return flags;
+}
+
+int SvgDocument::buildShapes(Shape *output, const int *pathIndices, int count, bool applyTransformation) const {
+    int successCount = 0;
+#ifdef MSDFGEN_USE_OPENMP
+    #pragma omp parallel for reduction(+:successCount)
+#endif
+    for (int i = 0; i < count; ++i) {
+        if (buildShape(output[i], pathIndices ? pathIndices[i] : i, applyTransformation)&SVG_IMPORT_SUCCESS_FLAG)
+            ++successCount;
+    }
+    return successCount;
+}
+
 #ifndef MSDFGEN_USE_SKIA
 
 #ifdef MSDFGEN_USE_TINYXML2
@@ -594,7 +1061,7 @@ int loadSvgShape(Shape &output, Shape::Bounds &viewBox, const char *filename) {
     viewBox.t = viewBox.b+dims.y;
     output.contours.clear();
     output.setYAxisOrientation(Y_DOWNWARD);
-    if (!buildShapeFromSvgPath(output, xmlDecode(pathAggregator.pathDefs.back().start, pathAggregator.pathDefs.back().end).c_str(), ENDPOINT_SNAP_RANGE_PROPORTION*dims.length()))
+    if (!buildShapeFromXmlPath(output, pathAggregator.pathDefs.back().start, pathAggregator.pathDefs.back().end, ENDPOINT_SNAP_RANGE_PROPORTION*dims.length()))
         return SVG_IMPORT_FAILURE;
     return SVG_IMPORT_SUCCESS_FLAG|pathAggregator.flags;
 }
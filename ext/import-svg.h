@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include <vector>
+#include <string>
 #include "../core/Shape.h"
 
 #ifndef MSDFGEN_DISABLE_SVG
@@ -20,6 +22,8 @@ extern MSDFGEN_EXT_PUBLIC const int SVG_IMPORT_TRANSFORMATION_IGNORED_FLAG;
 
 /// Builds a shape from an SVG path string
 bool buildShapeFromSvgPath(Shape &shape, const char *pathDef, double endpointSnapRange = 0);
+/// Builds a shape from an SVG path definition between pathDef and pathDefEnd (doesn't have to be null-terminated), avoids intermediate allocations
+bool buildShapeFromSvgPathRange(Shape &shape, const char *pathDef, const char *pathDefEnd, double endpointSnapRange = 0);
 
 /// Reads a single <path> element found in the specified SVG file and converts it to output Shape
 bool loadSvgShape(Shape &output, const char *filename, int pathIndex = 0, Vector2 *dimensions = NULL);
@@ -27,6 +31,50 @@ bool loadSvgShape(Shape &output, const char *filename, int pathIndex = 0, Vector
 /// New version - if Skia is available, reads the entire geometry of the SVG file into the output Shape, otherwise may only read one path, returns SVG import flags
 int loadSvgShape(Shape &output, Shape::Bounds &viewBox, const char *filename);
 
+/// An SVG file parsed only once, whose individual <path> elements can then be converted to shapes on demand.
+class SvgDocument {
+
+public:
+    /// An indexed <path> element.
+    struct Path {
+        /// The value of the element's id attribute (empty if not present).
+        std::string id;
+        /// The decoded path definition (d attribute).
+        std::string pathDef;
+        /// The combined transformation of the element and its parent groups as matrix(a, b, c, d, e, f).
+        double transformation[6];
+        /// SVG import flags specific to this element.
+        int flags;
+    };
+
+    SvgDocument();
+    /// Reads and indexes the specified SVG file. Any previously loaded document is discarded.
+    bool load(const char *filename);
+    /// Parses and indexes an SVG file loaded in memory. Any previously loaded document is discarded.
+    bool parse(const char *svgData, size_t svgLength);
+    /// Returns the number of indexed <path> elements.
+    int pathCount() const;
+    /// Returns the path element at the specified index (in document order).
+    const Path &path(int index) const;
+    /// Returns the index of the path element with the specified id, or -1 if not found.
+    int findPath(const char *id) const;
+    /// Returns the view box of the document.
+    Shape::Bounds viewBox() const;
+    /// Returns SVG import flags concerning the document as a whole (e.g. presence of unsupported elements).
+    int flags() const;
+    /// Builds the shape of the path element at the specified index, returns SVG import flags.
+    int buildShape(Shape &output, int pathIndex, bool applyTransformation = true) const;
+    /// Builds the shapes of multiple path elements (all paths in order if pathIndices is NULL) in parallel, returns how many were built successfully.
+    int buildShapes(Shape *output, const int *pathIndices, int count, bool applyTransformation = true) const;
+
+private:
+    std::vector<Path> paths;
+    Vector2 dimensions;
+    Shape::Bounds bounds;
+    int documentFlags;
+
+};
+
 }
 
 #endif
@@ -20,6 +20,13 @@
 #include <cmath>
 #include <cstring>
 #include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
 
 #include "msdfgen.h"
 #ifdef MSDFGEN_EXTENSIONS
@@ -59,6 +66,38 @@ static bool is8bitFormat(Format format) {
     return format == PNG || format == BMP || format == RGBA || format == TEXT || format == BINARY;
 }
 
+/// Parses the name of an output format. Sets defaultOutput to the default output filename for the format unless it is auto. Returns false if the name is unknown.
+static bool parseFormat(Format &format, const char *&defaultOutput, const char *name) {
+    #define FORMAT_CASE(s, fmt, ext) if (!strcmp(name, s)) { format = fmt; defaultOutput = "output." ext; return true; }
+    if (!strcmp(name, "auto")) {
+        format = AUTO;
+        return true;
+    }
+#if defined(MSDFGEN_EXTENSIONS) && !defined(MSDFGEN_DISABLE_PNG)
+    FORMAT_CASE("png", PNG, "png")
+#else
+    if (!strcmp(name, "png")) {
+        fputs("PNG format is not available in core-only version.\n", stderr);
+        return true;
+    }
+#endif
+    FORMAT_CASE("bmp", BMP, "bmp")
+    FORMAT_CASE("tiff", TIFF, "tiff")
+    FORMAT_CASE("tif", TIFF, "tiff")
+    FORMAT_CASE("rgba", RGBA, "rgba")
+    FORMAT_CASE("fl32", FL32, "fl32")
+    FORMAT_CASE("text", TEXT, "txt")
+    FORMAT_CASE("txt", TEXT, "txt")
+    FORMAT_CASE("textfloat", TEXT_FLOAT, "txt")
+    FORMAT_CASE("txtfloat", TEXT_FLOAT, "txt")
+    FORMAT_CASE("bin", BINARY, "bin")
+    FORMAT_CASE("binary", BINARY, "bin")
+    FORMAT_CASE("binfloat", BINARY_FLOAT, "bin")
+    FORMAT_CASE("binfloatle", BINARY_FLOAT, "bin")
+    FORMAT_CASE("binfloatbe", BINARY_FLOAT_BE, "bin")
+    return false;
+}
+
 static char toupper(char c) {
     return c >= 'a' && c <= 'z' ? c-'a'+'A' : c;
 }
@@ -191,7 +230,193 @@ static FontHandle *loadVarFont(FreetypeHandle *library, const char *filename) {
     return font;
 }
 #endif
+
+/// Keeps the FreeType library and the fonts it has loaded open so that subsequent jobs can reuse them.
+class FontCache {
+
+public:
+    FontCache() : ft(NULL), retainingGlyphs(false) { }
+    ~FontCache() {
+        for (std::map<std::string, FontHandle *>::const_iterator font = fonts.begin(); font != fonts.end(); ++font)
+            destroyFont(font->second);
+        if (ft)
+            deinitializeFreetype(ft);
+    }
+    /// From now on, keeps a copy of every loaded glyph, so that jobs which need the same glyph again don't have to load it from the font. Not thread-safe.
+    void retainGlyphs() {
+        retainingGlyphs = true;
+    }
+    /// Loads the glyph specified by its Unicode value, or by glyphIndex if unicode is zero, from the font file. Returns an error message on failure. Thread-safe.
+    const char *getGlyph(Shape &output, double *advance, const char *filename, bool variableFont, GlyphIndex glyphIndex, unicode_t unicode, FontCoordinateScaling coordinateScaling) {
+        const char *error = NULL;
+#ifdef MSDFGEN_USE_OPENMP
+        #pragma omp critical(fontCache)
+#endif
+        {
+            FontHandle *font = NULL;
+            std::string key = std::string(variableFont ? "var:" : "static:")+filename;
+            char glyphKey[32];
+            sprintf(glyphKey, "%c%u:%d:", unicode ? 'u' : 'g', unicode ? (unsigned) unicode : glyphIndex.getIndex(), int(coordinateScaling));
+            std::map<std::string, RetainedGlyph>::const_iterator retained = retainingGlyphs ? glyphs.find(glyphKey+key) : glyphs.end();
+            std::map<std::string, FontHandle *>::const_iterator cached = fonts.find(key);
+            if (retained != glyphs.end()) {
+                output = retained->second.shape;
+                if (advance)
+                    *advance = retained->second.advance;
+            } else if (cached != fonts.end())
+                font = cached->second;
+            else if (!(ft || (ft = initializeFreetype())))
+                error = "Failed to initialize FreeType library.";
+            else if ((font = (
+                #ifndef MSDFGEN_DISABLE_VARIABLE_FONTS
+                    variableFont ? loadVarFont(ft, filename) :
+                #endif
+                loadFont(ft, filename)
+            )))
+                fonts[key] = font;
+            else
+                error = "Failed to load font file.";
+            if (font) {
+                if (unicode)
+                    getGlyphIndex(glyphIndex, font, unicode);
+                RetainedGlyph glyph;
+                if (!loadGlyph(output, font, glyphIndex, coordinateScaling, &glyph.advance))
+                    error = "Failed to load glyph from font file.";
+                else {
+                    if (advance)
+                        *advance = glyph.advance;
+                    if (retainingGlyphs) {
+                        glyph.shape = output;
+                        glyphs[glyphKey+key] = glyph;
+                    }
+                }
+            }
+        }
+        return error;
+    }
+
+private:
+    struct RetainedGlyph {
+        Shape shape;
+        double advance;
+    };
+
+    FreetypeHandle *ft;
+    std::map<std::string, FontHandle *> fonts;
+    bool retainingGlyphs;
+    /// Retained glyphs by their Unicode value or index, coordinate scaling, and font.
+    std::map<std::string, RetainedGlyph> glyphs;
+
+    FontCache(const FontCache &);
+    FontCache &operator=(const FontCache &);
+
+};
+#endif
+
+#if defined(MSDFGEN_EXTENSIONS) && !defined(MSDFGEN_DISABLE_SVG)
+/// Keeps the shapes loaded from SVG files so that subsequent jobs with the same file don't have to parse it again.
+class SvgCache {
+
+public:
+    /// Loads the shape and view box from the SVG file like loadSvgShape, unless it has already been loaded, and returns the import flags. Thread-safe.
+    int getShape(Shape &output, Shape::Bounds &viewBox, const char *filename) {
+        int flags;
+#ifdef MSDFGEN_USE_OPENMP
+        #pragma omp critical(svgCache)
+#endif
+        {
+            std::map<std::string, CachedSvg>::const_iterator cached = svgs.find(filename);
+            if (cached != svgs.end()) {
+                output = cached->second.shape;
+                viewBox = cached->second.viewBox;
+                flags = cached->second.flags;
+            } else {
+                flags = loadSvgShape(output, viewBox, filename);
+                // Failures are not retained so that the file may still be fixed
+                if (flags&SVG_IMPORT_SUCCESS_FLAG) {
+                    CachedSvg &svg = svgs[filename];
+                    svg.shape = output;
+                    svg.viewBox = viewBox;
+                    svg.flags = flags;
+                }
+            }
+        }
+        return flags;
+    }
+
+private:
+    struct CachedSvg {
+        Shape shape;
+        Shape::Bounds viewBox;
+        int flags;
+    };
+
+    std::map<std::string, CachedSvg> svgs;
+
+};
+#endif
+
+/// Distance field generated by a job, which is returned in memory rather than saved.
+/// If target is set, a distance field of the preset dimensions and number of channels is generated directly into it, and pixels stay empty.
+struct JobOutput {
+    int width, height, channels;
+    std::vector<float> pixels;
+    /// Pixels of a section of a larger bitmap, whose rows are targetRowStride floats apart.
+    float *target;
+    int targetRowStride;
+
+    JobOutput() : width(0), height(0), channels(0), target(NULL), targetRowStride(0) { }
+};
+
+/// Resources shared by all jobs executed by the process.
+struct JobContext {
+#ifdef MSDFGEN_EXTENSIONS
+    FontCache fontCache;
 #endif
+#if defined(MSDFGEN_EXTENSIONS) && !defined(MSDFGEN_DISABLE_SVG)
+    SvgCache svgCache;
+#endif
+    /// Whether the legacy font coordinate conversion warning has already been printed, so that it doesn't repeat for every job.
+    bool legacyFontScalingWarned;
+
+    JobContext() : legacyFontScalingWarned(false) { }
+
+    /// Returns true only on the first call, which may come from any thread.
+    bool firstLegacyFontScalingWarning() {
+        bool first;
+#ifdef MSDFGEN_USE_OPENMP
+        #pragma omp critical(legacyFontScalingWarning)
+#endif
+        {
+            first = !legacyFontScalingWarned;
+            legacyFontScalingWarned = true;
+        }
+        return first;
+    }
+};
+
+/// Returns the target section of memoryOutput if the distance field fits it, otherwise allocates bitmap for it.
+template <int N>
+static BitmapSection<float, N> outputSection(Bitmap<float, N> &bitmap, JobOutput *memoryOutput, int width, int height) {
+    if (memoryOutput && memoryOutput->target && memoryOutput->width == width && memoryOutput->height == height && memoryOutput->channels == N)
+        return BitmapSection<float, N>(memoryOutput->target, width, height, memoryOutput->targetRowStride);
+    bitmap = Bitmap<float, N>(width, height);
+    return bitmap;
+}
+
+template <int N>
+static void storeOutput(JobOutput &output, const BitmapConstSection<float, N> &bitmap) {
+    // Already in place
+    if (output.target && bitmap.pixels == output.target)
+        return;
+    output.target = NULL;
+    output.width = bitmap.width;
+    output.height = bitmap.height;
+    output.channels = N;
+    output.pixels.resize(N*bitmap.width*bitmap.height);
+    for (int y = 0; y < bitmap.height; ++y)
+        memcpy(&output.pixels[N*bitmap.width*y], bitmap.pixels+y*bitmap.rowStride, N*bitmap.width*sizeof(float));
+}
 
 static bool writeTextBitmap(FILE *file, const float *values, int cols, int rows, int rowStride) {
     for (int row = 0; row < rows; ++row) {
@@ -266,7 +491,7 @@ static bool cmpExtension(const char *path, const char *ext) {
 }
 
 template <int N>
-static const char *writeOutput(const BitmapConstSection<float, N> &bitmap, const char *filename, Format &format) {
+static const char *writeOutput(const BitmapConstSection<float, N> &bitmap, const char *filename, Format &format, FILE *textOutput = stdout) {
     if (filename) {
         if (format == AUTO) {
         #if defined(MSDFGEN_EXTENSIONS) && !defined(MSDFGEN_DISABLE_PNG)
@@ -318,15 +543,30 @@ static const char *writeOutput(const BitmapConstSection<float, N> &bitmap, const
         }
     } else {
         if (format == AUTO || format == TEXT)
-            writeTextBitmap(stdout, bitmap.pixels, N*bitmap.width, bitmap.height, bitmap.rowStride);
+            writeTextBitmap(textOutput, bitmap.pixels, N*bitmap.width, bitmap.height, bitmap.rowStride);
         else if (format == TEXT_FLOAT)
-            writeTextBitmapFloat(stdout, bitmap.pixels, N*bitmap.width, bitmap.height, bitmap.rowStride);
+            writeTextBitmapFloat(textOutput, bitmap.pixels, N*bitmap.width, bitmap.height, bitmap.rowStride);
         else
             return "Unsupported format for standard output.";
     }
     return NULL;
 }
 
+template <int N>
+static std::vector<BitmapSection<float, N> > mipSections(const BitmapSection<float, N> &base, std::vector<Bitmap<float, N> > &mips) {
+    std::vector<BitmapSection<float, N> > sections(1, base);
+    for (typename std::vector<Bitmap<float, N> >::iterator mip = mips.begin(); mip != mips.end(); ++mip)
+        sections.push_back(*mip);
+    return sections;
+}
+
+template <int N>
+static const char *writeMipOutput(const BitmapSection<float, N> &base, std::vector<Bitmap<float, N> > &mips, const char *filename) {
+    std::vector<BitmapSection<float, N> > sections = mipSections(base, mips);
+    std::vector<BitmapConstSection<float, N> > levels(sections.begin(), sections.end());
+    return saveTiff(&levels[0], int(levels.size()), filename) ? NULL : "Failed to write output TIFF image.";
+}
+
 #define STRINGIZE_(x) #x
 #define STRINGIZE(x) STRINGIZE_(x)
 #define MSDFGEN_VERSION_STRING STRINGIZE(MSDFGEN_VERSION)
@@ -381,12 +621,17 @@ static const char *const helpText =
     "  metrics - Report shape metrics only.\n"
     "\n"
     "INPUT SPECIFICATION\n"
+    "  -binshape <filename.bin>\n"
+        "\tLoads a shape stored in the binary shape format.\n"
     "  -defineshape <definition>\n"
         "\tDefines input shape using the ad-hoc text definition.\n"
 #ifdef MSDFGEN_EXTENSIONS
     "  -font <filename.ttf> <character code>\n"
         "\tLoads a single glyph from the specified font file.\n"
         "\tFormat of character code is '?', 63, 0x3F (Unicode value), or g34 (glyph index).\n"
+    "  -font <filename.ttf> -charset <charset or filename>\n"
+        "\tGenerates each character of the charset, e.g. 0x20-0x7e,0xa0, in parallel.\n"
+        "\tOutput filenames must contain a conversion of the character code, e.g. out/%04x.png.\n"
 #endif
     "  -shapedesc <filename.txt>\n"
         "\tLoads text shape description from a file.\n"
@@ -403,6 +648,8 @@ static const char *const helpText =
     "\n"
     // Keep alphabetical order!
     "OPTIONS\n"
+    "  -adaptive <threshold>\n"
+        "\tEvaluates distance exactly only where interpolating a coarser grid appears to be off by more than threshold pixels. This is a heuristic, not an error bound.\n"
     "  -angle <angle>\n"
         "\tSpecifies the minimum angle between adjacent edges to be considered a corner. Append D for degrees.\n"
     "  -apxrange <outermost distance> <innermost distance>\n"
@@ -411,10 +658,19 @@ static const char *const helpText =
         "\tSpecifies the outermost (negative) and innermost representable distance in shape units.\n"
     "  -ascale <x scale> <y scale>\n"
         "\tSets the scale used to convert shape units to pixels asymmetrically.\n"
+#ifdef MSDFGEN_EXTENSIONS
+    "  -atlas <layout.json>\n"
+        "\tWith -charset, generates all glyphs into a single atlas and saves its layout. Scale is in pixels per em (32 by default).\n"
+        "\tOther options apply to each glyph, except those that set its frame. Regions can be separated by -spacing <pixels>.\n"
+#endif
     "  -autoframe\n"
         "\tAutomatically scales (unless specified) and translates the shape to fit.\n"
+    "  -batch <jobs.txt>\n"
+        "\tRuns each line of the file, or the standard input if -, as a separate job with its own arguments in addition to the rest.\n"
     "  -coloringstrategy <simple / inktrap / distance>\n"
         "\tSelects the strategy of the edge coloring heuristic.\n"
+    "  -cubictolerance <tolerance>\n"
+        "\tSets the acceptable distance error in pixels for cubic curves to speed up their processing.\n"
     "  -dimensions <width> <height>\n"
         "\tSets the dimensions of the output image.\n"
     "  -edgecolors <sequence>\n"
@@ -431,12 +687,16 @@ static const char *const helpText =
         "\tSets the minimum ratio between the pre-correction distance error and the post-correction distance error.\n"
     "  -estimateerror\n"
         "\tComputes and prints the distance field's estimated fill error to the standard output.\n"
+    "  -exportbinshape <filename.bin>\n"
+        "\tSaves the shape into a binary file that can be loaded using -binshape.\n"
     "  -exportshape <filename.txt>\n"
         "\tSaves the shape description into a text file that can be edited and loaded using -shapedesc.\n"
     "  -exportsvg <filename.svg>\n"
         "\tSaves the shape geometry into a simple SVG file.\n"
     "  -fillrule <nonzero / evenodd / positive / negative>\n"
         "\tSets the fill rule for the scanline pass. Default is nonzero.\n"
+    "  -flatten <tolerance>\n"
+        "\tApproximates curved edges by line segments deviating at most by the specified distance in pixels.\n"
 #if defined(MSDFGEN_EXTENSIONS) && !defined(MSDFGEN_DISABLE_PNG)
     "  -format <png / bmp / tiff / rgba / fl32 / text / textfloat / bin / binfloat / binfloatbe>\n"
 #else
@@ -449,6 +709,11 @@ static const char *const helpText =
         "\tDisplays this help.\n"
     "  -legacy\n"
         "\tUses the original (legacy) distance field algorithms.\n"
+    "  -mips <levels>\n"
+        "\tAlso generates the following mipmap levels with halved dimensions and saves all of them into a single TIFF file.\n"
+    "  -narrowband <width>\n"
+        "\tComputes exact distances only within the given number of pixels of the edges and propagates them elsewhere. Only for sdf and mtsdf.\n"
+        "\tIn mtsdf mode, all four channels hold the approximate true distance outside of the band.\n"
 #ifdef MSDFGEN_EXTENSIONS
     "  -noemnormalize\n"
         "\tRaw integer font glyph coordinates will be used. Without this option, legacy scaling will be applied.\n"
@@ -464,9 +729,11 @@ static const char *const helpText =
 #endif
     "  -o <filename>\n"
         "\tSets the output file name. The default value is \"output." DEFAULT_IMAGE_EXTENSION "\".\n"
-#ifdef MSDFGEN_USE_SKIA
-    "  -overlap\n"
-        "\tSwitches to distance field generator with support for overlapping contours.\n"
+    "  -overlap [auto]\n"
+        "\tSwitches to distance field generator with support for overlapping contours. With auto, it is used only if overlaps can't be ruled out.\n"
+#ifndef MSDFGEN_USE_SKIA
+    "  -preprocess\n"
+        "\tEnables path preprocessing which resolves self-intersections and overlapping contours.\n"
 #endif
     "  -printmetrics\n"
         "\tPrints relevant metrics of the shape to the standard output.\n"
@@ -474,6 +741,8 @@ static const char *const helpText =
         "\tSets the width of the range between the lowest and highest signed distance in pixels.\n"
     "  -range <range>\n"
         "\tSets the width of the range between the lowest and highest signed distance in shape units.\n"
+    "  -raster <supersampling>\n"
+        "\tGenerates an approximate SDF much faster by a distance transform of the shape rasterized with the given supersampling.\n"
     "  -reversewinding\n"
         "\tGenerates the distance field as if the shape's vertices were in reverse order.\n"
     "  -scale <scale>\n"
@@ -484,6 +753,8 @@ static const char *const helpText =
 #endif
     "  -seed <n>\n"
         "\tSets the random seed for edge coloring heuristic.\n"
+    "  -server\n"
+        "\tRuns each line of the standard input as a job and returns its printed text and distance field through the standard output.\n"
     "  -stdout\n"
         "\tPrints the output instead of storing it in a file. Only text formats are supported.\n"
     "  -testrender <filename." DEFAULT_IMAGE_EXTENSION "> <width> <height>\n"
@@ -527,7 +798,9 @@ static const char *errorCorrectionHelpText =
         "\tDisplays this help.\n"
     "\n";
 
-int main(int argc, const char *const *argv) {
+/// Performs the job specified by command line arguments, returns the program's exit code.
+/// Printed information such as metrics goes to textOutput. If memoryOutput is not null, it receives the distance field, which is then not saved into the output file.
+static int runJob(int argc, const char *const *argv, JobContext &context, FILE *textOutput = stdout, JobOutput *memoryOutput = NULL) {
     #define ABORT(msg) do { fputs(msg "\n", stderr); return 1; } while (false)
 
     // Parse command line arguments
@@ -538,7 +811,8 @@ int main(int argc, const char *const *argv) {
         VAR_FONT,
         DESCRIPTION_ARG,
         DESCRIPTION_STDIN,
-        DESCRIPTION_FILE
+        DESCRIPTION_FILE,
+        BINARY_SHAPE_FILE
     } inputType = NONE;
     enum {
         SINGLE,
@@ -562,11 +836,13 @@ int main(int argc, const char *const *argv) {
     MSDFGeneratorConfig generatorConfig;
     generatorConfig.overlapSupport = geometryPreproc == NO_PREPROCESS;
     bool scanlinePass = geometryPreproc == NO_PREPROCESS;
+    bool overlapSpecified = false, scanlineSpecified = false;
     FillRule fillRule = FILL_NONZERO;
     Format format = AUTO;
     const char *input = NULL;
     const char *output = "output." DEFAULT_IMAGE_EXTENSION;
     const char *shapeExport = NULL;
+    const char *binaryShapeExport = NULL;
     const char *svgExport = NULL;
     const char *testRender = NULL;
     const char *testRenderMulti = NULL;
@@ -580,6 +856,10 @@ int main(int argc, const char *const *argv) {
 #endif
 
     int width = 64, height = 64;
+    int mipLevels = 1;
+    double adaptiveThreshold = 0;
+    int rasterSupersampling = 0;
+    double narrowBandWidth = 0;
     int testWidth = 0, testHeight = 0;
     int testWidthM = 0, testHeightM = 0;
     bool autoFrame = false;
@@ -607,6 +887,7 @@ int main(int argc, const char *const *argv) {
     unsigned long long coloringSeed = 0;
     void (*edgeColoring)(Shape &, double, unsigned long long) = &edgeColoringSimple;
     bool explicitErrorCorrectionMode = false;
+    double flattenTolerance = 0;
 
     int argPos = 1;
     bool suggestHelp = false;
@@ -616,7 +897,6 @@ int main(int argc, const char *const *argv) {
         #define ARG_CASE_OR ) || !strcmp(arg,
         #define ARG_MODE(s, m) if (!strcmp(arg, s)) { mode = m; ++argPos; continue; }
         #define ARG_IS(s) (!strcmp(argv[argPos], s))
-        #define SET_FORMAT(fmt, ext) do { format = fmt; if (!outputSpecified) output = "output." ext; } while (false)
 
         // Accept arguments prefixed with -- instead of -
         if (arg[0] == '-' && arg[1] == '-')
@@ -702,6 +982,11 @@ int main(int argc, const char *const *argv) {
             input = argv[argPos++];
             continue;
         }
+        ARG_CASE("-binshape", 1) {
+            inputType = BINARY_SHAPE_FILE;
+            input = argv[argPos++];
+            continue;
+        }
         ARG_CASE("-o" ARG_CASE_OR "-out" ARG_CASE_OR "-output" ARG_CASE_OR "-imageout", 1) {
             output = argv[argPos++];
             outputSpecified = true;
@@ -732,22 +1017,31 @@ int main(int argc, const char *const *argv) {
             continue;
         }
         ARG_CASE("-nooverlap", 0) {
+            overlapSpecified = true;
             generatorConfig.overlapSupport = false;
+            generatorConfig.overlapDetection = false;
             continue;
         }
         ARG_CASE("-overlap", 0) {
+            overlapSpecified = true;
             generatorConfig.overlapSupport = true;
+            generatorConfig.overlapDetection = argPos < argc && ARG_IS("auto");
+            if (generatorConfig.overlapDetection)
+                ++argPos;
             continue;
         }
         ARG_CASE("-noscanline", 0) {
+            scanlineSpecified = true;
             scanlinePass = false;
             continue;
         }
         ARG_CASE("-scanline", 0) {
+            scanlineSpecified = true;
             scanlinePass = true;
             continue;
         }
         ARG_CASE("-fillrule", 1) {
+            scanlineSpecified = true;
             scanlinePass = true;
             if (ARG_IS("nonzero")) fillRule = FILL_NONZERO;
             else if (ARG_IS("evenodd") || ARG_IS("odd")) fillRule = FILL_ODD;
@@ -759,25 +1053,11 @@ int main(int argc, const char *const *argv) {
             continue;
         }
         ARG_CASE("-format", 1) {
-            if (ARG_IS("auto")) format = AUTO;
-        #if defined(MSDFGEN_EXTENSIONS) && !defined(MSDFGEN_DISABLE_PNG)
-            else if (ARG_IS("png")) SET_FORMAT(PNG, "png");
-        #else
-            else if (ARG_IS("png"))
-                fputs("PNG format is not available in core-only version.\n", stderr);
-        #endif
-            else if (ARG_IS("bmp")) SET_FORMAT(BMP, "bmp");
-            else if (ARG_IS("tiff") || ARG_IS("tif")) SET_FORMAT(TIFF, "tiff");
-            else if (ARG_IS("rgba")) SET_FORMAT(RGBA, "rgba");
-            else if (ARG_IS("fl32")) SET_FORMAT(FL32, "fl32");
-            else if (ARG_IS("text") || ARG_IS("txt")) SET_FORMAT(TEXT, "txt");
-            else if (ARG_IS("textfloat") || ARG_IS("txtfloat")) SET_FORMAT(TEXT_FLOAT, "txt");
-            else if (ARG_IS("bin") || ARG_IS("binary")) SET_FORMAT(BINARY, "bin");
-            else if (ARG_IS("binfloat") || ARG_IS("binfloatle")) SET_FORMAT(BINARY_FLOAT, "bin");
-            else if (ARG_IS("binfloatbe")) SET_FORMAT(BINARY_FLOAT_BE, "bin");
-            else
+            const char *defaultOutput = NULL;
+            if (!parseFormat(format, defaultOutput, argv[argPos++]))
                 fputs("Unknown format specified.\n", stderr);
-            ++argPos;
+            else if (defaultOutput && !outputSpecified)
+                output = defaultOutput;
             continue;
         }
         ARG_CASE("-dimensions" ARG_CASE_OR "-size", 2) {
@@ -787,6 +1067,30 @@ int main(int argc, const char *const *argv) {
             width = w, height = h;
             continue;
         }
+        ARG_CASE("-adaptive", 1) {
+            if (!(parseDouble(adaptiveThreshold, argv[argPos++]) && adaptiveThreshold > 0))
+                ABORT("Invalid adaptive threshold. Use -adaptive <threshold> with a positive real number of pixels.");
+            continue;
+        }
+        ARG_CASE("-narrowband", 1) {
+            if (!(parseDouble(narrowBandWidth, argv[argPos++]) && narrowBandWidth > 0))
+                ABORT("Invalid narrow band width. Use -narrowband <width> with a positive real number of pixels.");
+            continue;
+        }
+        ARG_CASE("-raster", 1) {
+            unsigned supersampling;
+            if (!(parseUnsigned(supersampling, argv[argPos++]) && supersampling))
+                ABORT("Invalid supersampling. Use -raster <supersampling> with a positive integer.");
+            rasterSupersampling = (int) supersampling;
+            continue;
+        }
+        ARG_CASE("-mips", 1) {
+            unsigned levels;
+            if (!(parseUnsigned(levels, argv[argPos++]) && levels))
+                ABORT("Invalid number of mipmap levels. Use -mips <levels> with a positive integer.");
+            mipLevels = (int) levels;
+            continue;
+        }
         ARG_CASE("-autoframe", 0) {
             autoFrame = true;
             continue;
@@ -887,7 +1191,7 @@ int main(int argc, const char *const *argv) {
                 generatorConfig.errorCorrection.mode = ErrorCorrectionConfig::EDGE_ONLY;
                 generatorConfig.errorCorrection.distanceCheckMode = ErrorCorrectionConfig::ALWAYS_CHECK_DISTANCE;
             } else if (ARG_IS("help")) {
-                puts(errorCorrectionHelpText);
+                fprintf(textOutput, "%s\n", errorCorrectionHelpText);
                 return 0;
             } else
                 fputs("Unknown error correction mode. Use -errorcorrection help for more information.\n", stderr);
@@ -909,6 +1213,20 @@ int main(int argc, const char *const *argv) {
             generatorConfig.errorCorrection.minImproveRatio = eir;
             continue;
         }
+        ARG_CASE("-cubictolerance", 1) {
+            double ct;
+            if (!(parseDouble(ct, argv[argPos++]) && ct >= 0))
+                ABORT("Invalid cubic search tolerance. Use -cubictolerance <tolerance> with a non-negative real number.");
+            generatorConfig.cubicSearchTolerance = ct;
+            continue;
+        }
+        ARG_CASE("-flatten", 1) {
+            double ft;
+            if (!(parseDouble(ft, argv[argPos++]) && ft > 0))
+                ABORT("Invalid flattening tolerance. Use -flatten <tolerance> with a positive real number.");
+            flattenTolerance = ft;
+            continue;
+        }
         ARG_CASE("-coloringstrategy" ARG_CASE_OR "-edgecoloring", 1) {
             if (ARG_IS("simple")) edgeColoring = &edgeColoringSimple;
             else if (ARG_IS("inktrap")) edgeColoring = &edgeColoringInkTrap;
@@ -941,6 +1259,10 @@ int main(int argc, const char *const *argv) {
             shapeExport = argv[argPos++];
             continue;
         }
+        ARG_CASE("-exportbinshape", 1) {
+            binaryShapeExport = argv[argPos++];
+            continue;
+        }
         ARG_CASE("-exportsvg", 1) {
             svgExport = argv[argPos++];
             continue;
@@ -991,11 +1313,11 @@ int main(int argc, const char *const *argv) {
             continue;
         }
         ARG_CASE("-version", 0) {
-            puts(versionText);
+            fprintf(textOutput, "%s\n", versionText);
             return 0;
         }
         ARG_CASE("-help", 0) {
-            puts(helpText);
+            fprintf(textOutput, "%s\n", helpText);
             return 0;
         }
         fprintf(stderr, "Unknown setting or insufficient parameters: %s\n", argv[argPos++]);
@@ -1003,6 +1325,13 @@ int main(int argc, const char *const *argv) {
     }
     if (suggestHelp)
         fprintf(stderr, "Use -help for more information.\n");
+    // Preprocessed geometry needs neither overlap support nor the scanline pass, as when preprocessing is the default
+    if (geometryPreproc == FULL_PREPROCESS) {
+        if (!overlapSpecified)
+            generatorConfig.overlapSupport = false;
+        if (!scanlineSpecified)
+            scanlinePass = false;
+    }
 
     // Load input
     Shape::Bounds svgViewBox = { };
@@ -1018,11 +1347,31 @@ int main(int argc, const char *const *argv) {
             ABORT("No input specified! See -help.");
         #endif
     }
+    if (adaptiveThreshold > 0 && (legacyMode || mipLevels > 1))
+        ABORT("Adaptive generation cannot be combined with legacy mode or mipmap levels.");
+    if (rasterSupersampling) {
+        if (mode != SINGLE)
+            ABORT("Generation from a raster is only available for monochrome SDF.");
+        if (legacyMode || mipLevels > 1 || adaptiveThreshold > 0)
+            ABORT("Generation from a raster cannot be combined with legacy mode, mipmap levels, or adaptive generation.");
+    }
+    if (narrowBandWidth > 0) {
+        if (!(mode == SINGLE || mode == MULTI_AND_TRUE))
+            ABORT("Narrow band generation is only available for sdf and mtsdf.");
+        if (legacyMode || mipLevels > 1 || adaptiveThreshold > 0 || rasterSupersampling)
+            ABORT("Narrow band generation cannot be combined with legacy mode, mipmap levels, adaptive generation, or generation from a raster.");
+    }
+    if (mipLevels > 1) {
+        if (legacyMode)
+            ABORT("Mipmap levels are not supported in legacy mode.");
+        if (!memoryOutput && !(format == TIFF || (format == AUTO && output && (cmpExtension(output, ".tiff") || cmpExtension(output, ".tif")))))
+            ABORT("Mipmap levels can only be saved as TIFF. Use -o <filename.tiff>.");
+    }
     Shape shape;
     switch (inputType) {
     #if defined(MSDFGEN_EXTENSIONS) && !defined(MSDFGEN_DISABLE_SVG)
         case SVG: {
-            int svgImportFlags = loadSvgShape(shape, svgViewBox, input);
+            int svgImportFlags = context.svgCache.getShape(shape, svgViewBox, input);
             if (!(svgImportFlags&SVG_IMPORT_SUCCESS_FLAG))
                 ABORT("Failed to load shape from SVG file.");
             if (svgImportFlags&SVG_IMPORT_PARTIAL_FAILURE_FLAG)
@@ -1040,32 +1389,11 @@ int main(int argc, const char *const *argv) {
         case FONT: case VAR_FONT: {
             if (!glyphIndexSpecified && !unicode)
                 ABORT("No character specified! Use -font <file.ttf/otf> <character code>. Character code can be a Unicode index (65, 0x41), a character in apostrophes ('A'), or a glyph index prefixed by g (g36, g0x24).");
-            struct FreetypeFontGuard {
-                FreetypeHandle *ft;
-                FontHandle *font;
-                FreetypeFontGuard() : ft(), font() { }
-                ~FreetypeFontGuard() {
-                    if (ft) {
-                        if (font)
-                            destroyFont(font);
-                        deinitializeFreetype(ft);
-                    }
-                }
-            } guard;
-            if (!(guard.ft = initializeFreetype()))
-                ABORT("Failed to initialize FreeType library.");
-            if (!(guard.font = (
-                #ifndef MSDFGEN_DISABLE_VARIABLE_FONTS
-                    inputType == VAR_FONT ? loadVarFont(guard.ft, input) :
-                #endif
-                loadFont(guard.ft, input)
-            )))
-                ABORT("Failed to load font file.");
-            if (unicode)
-                getGlyphIndex(glyphIndex, guard.font, unicode);
-            if (!loadGlyph(shape, guard.font, glyphIndex, fontCoordinateScaling, &glyphAdvance))
-                ABORT("Failed to load glyph from font file.");
-            if (!fontCoordinateScalingSpecified && (!autoFrame || scaleSpecified || rangeMode == RANGE_UNIT || mode == METRICS || printMetrics || shapeExport || svgExport)) {
+            if (const char *error = context.fontCache.getGlyph(shape, &glyphAdvance, input, inputType == VAR_FONT, glyphIndex, unicode, fontCoordinateScaling)) {
+                fprintf(stderr, "%s\n", error);
+                return 1;
+            }
+            if (!fontCoordinateScalingSpecified && (!autoFrame || scaleSpecified || rangeMode == RANGE_UNIT || mode == METRICS || printMetrics || shapeExport || binaryShapeExport || svgExport) && context.firstLegacyFontScalingWarning()) {
                 fputs(
                     "Warning: Using legacy font coordinate conversion for compatibility reasons.\n"
                     "         The implicit scaling behavior will likely change in a future version resulting in different output.\n"
@@ -1097,6 +1425,16 @@ int main(int argc, const char *const *argv) {
                 ABORT("Parse error in shape description.");
             break;
         }
+        case BINARY_SHAPE_FILE: {
+            FILE *file = fopen(input, "rb");
+            if (!file)
+                ABORT("Failed to load binary shape file.");
+            bool readSuccessful = readShapeBinary(file, shape, &skipColoring);
+            fclose(file);
+            if (!readSuccessful)
+                ABORT("Invalid binary shape file.");
+            break;
+        }
         default:;
     }
 
@@ -1109,18 +1447,20 @@ int main(int argc, const char *const *argv) {
         case WINDING_PREPROCESS:
             shape.orientContours();
             break;
-        case FULL_PREPROCESS:
+        case FULL_PREPROCESS: {
             #ifdef MSDFGEN_USE_SKIA
-                if (!resolveShapeGeometry(shape))
-                    fputs("Shape geometry preprocessing failed, skipping.\n", stderr);
-                else if (skipColoring) {
-                    skipColoring = false;
-                    fputs("Note: Input shape coloring won't be preserved due to geometry preprocessing.\n", stderr);
-                }
+                bool resolved = resolveShapeGeometry(shape);
             #else
-                ABORT("Shape geometry preprocessing (-preprocess) is not available in this version because the Skia library is not present.");
+                bool resolved = resolveShapeOverlaps(shape, fillRule);
             #endif
+            if (!resolved)
+                fputs("Shape geometry preprocessing failed, skipping.\n", stderr);
+            else if (skipColoring) {
+                skipColoring = false;
+                fputs("Note: Input shape coloring won't be preserved due to geometry preprocessing.\n", stderr);
+            }
             break;
+        }
     }
     shape.normalize();
     if (yFlip)
@@ -1184,9 +1524,8 @@ int main(int argc, const char *const *argv) {
 
     // Print metrics
     if (mode == METRICS || printMetrics) {
-        FILE *out = stdout;
-        if (mode == METRICS && outputSpecified)
-            out = fopen(output, "w");
+        bool metricsFile = mode == METRICS && outputSpecified && !memoryOutput;
+        FILE *out = metricsFile ? fopen(output, "w") : textOutput;
         if (!out)
             ABORT("Failed to write output file.");
         switch (shape.getYAxisOrientation()) {
@@ -1210,15 +1549,41 @@ int main(int argc, const char *const *argv) {
         }
         if (rangeMode == RANGE_PX)
             fprintf(out, "range %.17g to %.17g\n", range.lower, range.upper);
-        if (mode == METRICS && outputSpecified)
+        if (metricsFile)
             fclose(out);
     }
 
     // Compute output
     SDFTransformation transformation(Projection(scale, translate), range);
-    Bitmap<float, 1> sdf;
-    Bitmap<float, 3> msdf;
-    Bitmap<float, 4> mtsdf;
+    Bitmap<float, 1> sdfBitmap;
+    Bitmap<float, 3> msdfBitmap;
+    Bitmap<float, 4> mtsdfBitmap;
+    BitmapSection<float, 1> sdf;
+    BitmapSection<float, 3> msdf;
+    BitmapSection<float, 4> mtsdf;
+    // Mipmap levels after the first frame the same area with halved dimensions and the same range in pixels or shape units
+    std::vector<SDFTransformation> mipTransformations(1, transformation);
+    int evaluationsSaved = 0;
+    std::vector<Bitmap<float, 1> > sdfMips;
+    std::vector<Bitmap<float, 3> > msdfMips;
+    std::vector<Bitmap<float, 4> > mtsdfMips;
+    for (int level = 1; level < mipLevels; ++level) {
+        int mipWidth = max(width>>level, 1), mipHeight = max(height>>level, 1);
+        Vector2 mipScale(scale.x*mipWidth/width, scale.y*mipHeight/height);
+        mipTransformations.push_back(SDFTransformation(Projection(mipScale, translate), rangeMode == RANGE_PX ? pxRange/min(mipScale.x, mipScale.y) : range));
+        switch (mode) {
+            case SINGLE: case PERPENDICULAR:
+                sdfMips.push_back(Bitmap<float, 1>(mipWidth, mipHeight));
+                break;
+            case MULTI:
+                msdfMips.push_back(Bitmap<float, 3>(mipWidth, mipHeight));
+                break;
+            case MULTI_AND_TRUE:
+                mtsdfMips.push_back(Bitmap<float, 4>(mipWidth, mipHeight));
+                break;
+            default:;
+        }
+    }
     MSDFGeneratorConfig postErrorCorrectionConfig(generatorConfig);
     if (scanlinePass) {
         if (explicitErrorCorrectionMode && generatorConfig.errorCorrection.distanceCheckMode != ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE) {
@@ -1234,43 +1599,72 @@ int main(int argc, const char *const *argv) {
         generatorConfig.errorCorrection.mode = ErrorCorrectionConfig::DISABLED;
         postErrorCorrectionConfig.errorCorrection.distanceCheckMode = ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE;
     }
+    if (mode == MULTI || mode == MULTI_AND_TRUE) {
+        if (!skipColoring)
+            edgeColoring(shape, angleThreshold, coloringSeed);
+        if (edgeAssignment)
+            parseColoring(shape, edgeAssignment);
+    }
+    // Flatten after edge coloring so that the line segments inherit the colors of the curves
+    if (flattenTolerance > 0)
+        flattenShape(shape, flattenTolerance/min(scale.x, scale.y));
     switch (mode) {
         case SINGLE: {
-            sdf = Bitmap<float, 1>(width, height);
+            sdf = outputSection(sdfBitmap, memoryOutput, width, height);
             if (legacyMode)
                 generateSDF_legacy(sdf, shape, range, scale, translate);
-            else
+            else if (mipLevels > 1)
+                generateSDFLevels(&mipSections(sdf, sdfMips)[0], shape, &mipTransformations[0], mipLevels, generatorConfig);
+            else if (adaptiveThreshold > 0)
+                evaluationsSaved = generateSDFAdaptive(sdf, shape, transformation, adaptiveThreshold, generatorConfig);
+            else if (narrowBandWidth > 0)
+                generateSDFNarrowBand(sdf, shape, transformation, narrowBandWidth, generatorConfig);
+            else if (rasterSupersampling) {
+                Bitmap<float, 1> mask(rasterSupersampling*width, rasterSupersampling*height);
+                rasterize(mask, shape, Projection(rasterSupersampling*scale, translate), fillRule);
+                generateSDFFromBitmap(sdf, mask, transformation);
+            } else
                 generateSDF(sdf, shape, transformation, generatorConfig);
             break;
         }
         case PERPENDICULAR: {
-            sdf = Bitmap<float, 1>(width, height);
+            sdf = outputSection(sdfBitmap, memoryOutput, width, height);
             if (legacyMode)
                 generatePSDF_legacy(sdf, shape, range, scale, translate);
+            else if (mipLevels > 1)
+                generatePSDFLevels(&mipSections(sdf, sdfMips)[0], shape, &mipTransformations[0], mipLevels, generatorConfig);
+            else if (adaptiveThreshold > 0)
+                evaluationsSaved = generatePSDFAdaptive(sdf, shape, transformation, adaptiveThreshold, generatorConfig);
             else
                 generatePSDF(sdf, shape, transformation, generatorConfig);
             break;
         }
         case MULTI: {
-            if (!skipColoring)
-                edgeColoring(shape, angleThreshold, coloringSeed);
-            if (edgeAssignment)
-                parseColoring(shape, edgeAssignment);
-            msdf = Bitmap<float, 3>(width, height);
+            msdf = outputSection(msdfBitmap, memoryOutput, width, height);
             if (legacyMode)
                 generateMSDF_legacy(msdf, shape, range, scale, translate, generatorConfig.errorCorrection);
+            else if (mipLevels > 1)
+                generateMSDFLevels(&mipSections(msdf, msdfMips)[0], shape, &mipTransformations[0], mipLevels, generatorConfig);
+            else if (adaptiveThreshold > 0)
+                evaluationsSaved = generateMSDFAdaptive(msdf, shape, transformation, adaptiveThreshold, generatorConfig);
             else
                 generateMSDF(msdf, shape, transformation, generatorConfig);
             break;
         }
         case MULTI_AND_TRUE: {
-            if (!skipColoring)
-                edgeColoring(shape, angleThreshold, coloringSeed);
-            if (edgeAssignment)
-                parseColoring(shape, edgeAssignment);
-            mtsdf = Bitmap<float, 4>(width, height);
+            mtsdf = outputSection(mtsdfBitmap, memoryOutput, width, height);
             if (legacyMode)
                 generateMTSDF_legacy(mtsdf, shape, range, scale, translate, generatorConfig.errorCorrection);
+            else if (mipLevels > 1)
+                generateMTSDFLevels(&mipSections(mtsdf, mtsdfMips)[0], shape, &mipTransformations[0], mipLevels, generatorConfig);
+            else if (adaptiveThreshold > 0)
+                evaluationsSaved = generateMTSDFAdaptive(mtsdf, shape, transformation, adaptiveThreshold, generatorConfig);
+            else if (narrowBandWidth > 0) {
+                // Outside of the band, the color channels hold the true distance, which only goes unnoticed where it is clamped
+                if (narrowBandWidth < max(fabs(range.lower), fabs(range.upper))*min(scale.x, scale.y))
+                    fputs("Warning: Narrow band is narrower than the distance range, color channels will not hold multi-channel distance everywhere.\n", stderr);
+                generateMTSDFNarrowBand(mtsdf, shape, transformation, narrowBandWidth, generatorConfig);
+            }
             else
                 generateMTSDF(mtsdf, shape, transformation, generatorConfig);
             break;
@@ -1278,6 +1672,9 @@ int main(int argc, const char *const *argv) {
         default:;
     }
 
+    if (adaptiveThreshold > 0)
+        fprintf(stderr, "exact evaluations saved = %d of %d\n", evaluationsSaved, width*height);
+
     if (scanlinePass) {
         float sdfZeroValue = range.lower != range.upper ? float(range.lower/(range.lower-range.upper)) : .5f;
         switch (mode) {
@@ -1295,6 +1692,24 @@ int main(int argc, const char *const *argv) {
                 break;
             default:;
         }
+        for (int level = 1; level < mipLevels; ++level) {
+            const SDFTransformation &mipTransformation = mipTransformations[level];
+            switch (mode) {
+                case SINGLE:
+                case PERPENDICULAR:
+                    distanceSignCorrection(sdfMips[level-1], shape, mipTransformation, sdfZeroValue, fillRule);
+                    break;
+                case MULTI:
+                    distanceSignCorrection(msdfMips[level-1], shape, mipTransformation, sdfZeroValue, fillRule);
+                    msdfErrorCorrection(msdfMips[level-1], shape, mipTransformation, postErrorCorrectionConfig);
+                    break;
+                case MULTI_AND_TRUE:
+                    distanceSignCorrection(mtsdfMips[level-1], shape, mipTransformation, sdfZeroValue, fillRule);
+                    msdfErrorCorrection(mtsdfMips[level-1], shape, mipTransformation, postErrorCorrectionConfig);
+                    break;
+                default:;
+            }
+        }
     }
 
     // Save output
@@ -1305,6 +1720,13 @@ int main(int argc, const char *const *argv) {
         } else
             fputs("Failed to write shape export file.\n", stderr);
     }
+    if (binaryShapeExport) {
+        FILE *file = fopen(binaryShapeExport, "wb");
+        if (!(file && writeShapeBinary(file, shape, true)))
+            fputs("Failed to write binary shape export file.\n", stderr);
+        if (file)
+            fclose(file);
+    }
     if (svgExport) {
         if (!saveSvgShape(shape, bounds, svgExport))
             fputs("Failed to write shape SVG file.\n", stderr);
@@ -1313,7 +1735,9 @@ int main(int argc, const char *const *argv) {
     switch (mode) {
         case SINGLE:
         case PERPENDICULAR:
-            if ((error = writeOutput<1>(sdf, output, format))) {
+            if (memoryOutput)
+                storeOutput<1>(*memoryOutput, sdf);
+            else if ((error = mipLevels > 1 ? writeMipOutput<1>(sdf, sdfMips, output) : writeOutput<1>(sdf, output, format, textOutput))) {
                 fprintf(stderr, "%s\n", error);
                 return 1;
             }
@@ -1321,7 +1745,7 @@ int main(int argc, const char *const *argv) {
                 simulate8bit(sdf);
             if (estimateError) {
                 double sdfError = estimateSDFError(sdf, shape, transformation, SDF_ERROR_ESTIMATE_PRECISION, fillRule);
-                printf("SDF error ~ %e\n", sdfError);
+                fprintf(textOutput, "SDF error ~ %e\n", sdfError);
             }
             if (testRenderMulti) {
                 Bitmap<float, 3> render(testWidthM, testHeightM);
@@ -1341,7 +1765,9 @@ int main(int argc, const char *const *argv) {
             }
             break;
         case MULTI:
-            if ((error = writeOutput<3>(msdf, output, format))) {
+            if (memoryOutput)
+                storeOutput<3>(*memoryOutput, msdf);
+            else if ((error = mipLevels > 1 ? writeMipOutput<3>(msdf, msdfMips, output) : writeOutput<3>(msdf, output, format, textOutput))) {
                 fprintf(stderr, "%s\n", error);
                 return 1;
             }
@@ -1349,7 +1775,7 @@ int main(int argc, const char *const *argv) {
                 simulate8bit(msdf);
             if (estimateError) {
                 double sdfError = estimateSDFError(msdf, shape, transformation, SDF_ERROR_ESTIMATE_PRECISION, fillRule);
-                printf("SDF error ~ %e\n", sdfError);
+                fprintf(textOutput, "SDF error ~ %e\n", sdfError);
             }
             if (testRenderMulti) {
                 Bitmap<float, 3> render(testWidthM, testHeightM);
@@ -1369,7 +1795,9 @@ int main(int argc, const char *const *argv) {
             }
             break;
         case MULTI_AND_TRUE:
-            if ((error = writeOutput<4>(mtsdf, output, format))) {
+            if (memoryOutput)
+                storeOutput<4>(*memoryOutput, mtsdf);
+            else if ((error = mipLevels > 1 ? writeMipOutput<4>(mtsdf, mtsdfMips, output) : writeOutput<4>(mtsdf, output, format, textOutput))) {
                 fprintf(stderr, "%s\n", error);
                 return 1;
             }
@@ -1377,7 +1805,7 @@ int main(int argc, const char *const *argv) {
                 simulate8bit(mtsdf);
             if (estimateError) {
                 double sdfError = estimateSDFError(mtsdf, shape, transformation, SDF_ERROR_ESTIMATE_PRECISION, fillRule);
-                printf("SDF error ~ %e\n", sdfError);
+                fprintf(textOutput, "SDF error ~ %e\n", sdfError);
             }
             if (testRenderMulti) {
                 Bitmap<float, 4> render(testWidthM, testHeightM);
@@ -1402,4 +1830,615 @@ int main(int argc, const char *const *argv) {
     return 0;
 }
 
+/// Reads a line of text from file without the line break, returns false at the end of file.
+static bool readLine(std::string &line, FILE *file) {
+    line.clear();
+    int c;
+    while ((c = fgetc(file)) != EOF && c != '\n') {
+        if (c != '\r')
+            line.push_back(char(c));
+    }
+    return c != EOF || !line.empty();
+}
+
+/// Splits a line of a batch file into arguments separated by whitespace. Arguments enclosed in double quotes may contain whitespace and escaped quotes (\").
+static void splitArguments(std::vector<std::string> &arguments, const char *line) {
+    while (true) {
+        while (*line == ' ' || *line == '\t')
+            ++line;
+        if (!*line)
+            break;
+        std::string argument;
+        bool quoted = false;
+        for (; *line && (quoted || (*line != ' ' && *line != '\t')); ++line) {
+            if (*line == '"')
+                quoted = !quoted;
+            else if (quoted && line[0] == '\\' && line[1] == '"')
+                argument.push_back(*++line);
+            else
+                argument.push_back(*line);
+        }
+        arguments.push_back(argument);
+    }
+}
+
+/// Stream which collects the text printed by jobs, in memory where the platform allows it, otherwise in a temporary file.
+class TextBuffer {
+
+public:
+    TextBuffer() : buffer(NULL), size(0) {
+#ifdef _WIN32
+        file = tmpfile();
+#else
+        file = open_memstream(&buffer, &size);
+#endif
+    }
+    ~TextBuffer() {
+        if (file)
+            fclose(file);
+        free(buffer);
+    }
+    /// Empties the stream for the next job and returns it, or NULL if it couldn't be created.
+    FILE *begin() {
+        if (file)
+            rewind(file);
+        return file;
+    }
+    /// Retrieves the text printed into the stream since begin.
+    void end(std::string &text) {
+        text.clear();
+        if (!file)
+            return;
+        size_t length = size_t(ftell(file));
+#ifdef _WIN32
+        text.resize(length);
+        rewind(file);
+        if (length && fread(&text[0], 1, length, file) != length)
+            text.clear();
+#else
+        fflush(file);
+        text.assign(buffer, length);
+#endif
+    }
+
+private:
+    FILE *file;
+    char *buffer;
+    size_t size;
+
+    TextBuffer(const TextBuffer &);
+    TextBuffer &operator=(const TextBuffer &);
+
+};
+
+/// Runs each line of the batch file as a separate job, with the common arguments preceding its own. Returns the program's exit code.
+static int runBatch(const char *filename, const std::vector<const char *> &commonArgs) {
+    FILE *file = strcmp(filename, "-") ? fopen(filename, "r") : stdin;
+    if (!file) {
+        fputs("Failed to open batch file.\n", stderr);
+        return 1;
+    }
+    std::vector<std::vector<std::string> > jobs;
+    std::vector<int> jobLines;
+    std::string line;
+    for (int lineNumber = 1; readLine(line, file); ++lineNumber) {
+        std::vector<std::string> jobArgs;
+        splitArguments(jobArgs, line.c_str());
+        // Skip empty lines and comments
+        if (!jobArgs.empty() && *jobArgs[0].c_str() != '#') {
+            jobs.push_back(jobArgs);
+            jobLines.push_back(lineNumber);
+        }
+    }
+    if (file != stdin)
+        fclose(file);
+
+    JobContext context;
+    int jobCount = int(jobs.size());
+    int failedJobs = 0;
+#ifdef MSDFGEN_USE_OPENMP
+    #pragma omp parallel reduction(+:failedJobs)
+#endif
+    {
+        // Printed text is buffered so that it can be output in the order of the batch file
+        TextBuffer textBuffer;
+        std::string text;
+#ifdef MSDFGEN_USE_OPENMP
+        #pragma omp for schedule(dynamic) ordered
+#endif
+        for (int i = 0; i < jobCount; ++i) {
+            std::vector<const char *> argv(commonArgs);
+            for (std::vector<std::string>::const_iterator arg = jobs[i].begin(); arg != jobs[i].end(); ++arg)
+                argv.push_back(arg->c_str());
+            FILE *textOutput = textBuffer.begin();
+            bool success = !runJob(int(argv.size()), &argv[0], context, textOutput ? textOutput : stdout);
+            textBuffer.end(text);
+#ifdef MSDFGEN_USE_OPENMP
+            #pragma omp ordered
+#endif
+            {
+                fwrite(text.data(), 1, text.size(), stdout);
+                if (!success) {
+                    fprintf(stderr, "Job on line %d of batch file failed.\n", jobLines[i]);
+                    ++failedJobs;
+                }
+            }
+        }
+    }
+    return failedJobs ? 1 : 0;
+}
+
+/// Runs jobs read line by line from the standard input and responds to each with its results on the standard output. Returns the program's exit code.
+static int runServer(const std::vector<const char *> &commonArgs) {
+    TextBuffer textBuffer;
+    if (!textBuffer.begin()) {
+        fputs("Failed to create text buffer.\n", stderr);
+        return 1;
+    }
+#ifdef _WIN32
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    JobOutput output;
+    JobContext context;
+    std::string line, text;
+    while (readLine(line, stdin)) {
+        std::vector<std::string> jobArgs;
+        splitArguments(jobArgs, line.c_str());
+        if (jobArgs.empty())
+            continue;
+        std::vector<const char *> argv(commonArgs);
+        for (std::vector<std::string>::const_iterator arg = jobArgs.begin(); arg != jobArgs.end(); ++arg)
+            argv.push_back(arg->c_str());
+
+        output.width = 0, output.height = 0, output.channels = 0;
+        bool success = !runJob(int(argv.size()), &argv[0], context, textBuffer.begin(), &output);
+        if (!success)
+            output.width = 0, output.height = 0, output.channels = 0;
+        textBuffer.end(text);
+
+        // Response header is followed by the printed text and the distance field's pixels as 32-bit floats
+        printf("%s %d %d %d %d\n", success ? "OK" : "ERROR", int(text.size()), output.width, output.height, output.channels);
+        if (!text.empty())
+            fwrite(text.data(), 1, text.size(), stdout);
+        if (output.channels)
+            fwrite(&output.pixels[0], sizeof(float), output.channels*output.width*output.height, stdout);
+        fflush(stdout);
+    }
+    return 0;
+}
+
+#ifdef MSDFGEN_EXTENSIONS
+
+static bool isCharsetSeparator(char c) {
+    return c == ',' || c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool readCharsetCode(unicode_t &unicode, const char *&str) {
+    std::string code;
+    if (str[0] == '\'' && str[1] && str[2] == '\'') {
+        code.assign(str, 3);
+        str += 3;
+    } else {
+        while (*str && *str != '-' && !isCharsetSeparator(*str))
+            code.push_back(*str++);
+    }
+    return parseUnicode(unicode, code.c_str());
+}
+
+/// Parses a list of character codes and ranges of character codes (first-last) separated by commas or whitespace, and appends them to charset.
+static bool parseCharset(std::vector<unicode_t> &charset, const char *str) {
+    while (true) {
+        while (isCharsetSeparator(*str))
+            ++str;
+        if (!*str)
+            return true;
+        unicode_t first, last;
+        if (!readCharsetCode(first, str))
+            return false;
+        last = first;
+        if (*str == '-' && (!readCharsetCode(last, ++str) || last < first))
+            return false;
+        if (*str && !isCharsetSeparator(*str))
+            return false;
+        for (unicode_t unicode = first; charset.push_back(unicode), unicode < last; ++unicode);
+    }
+}
+
+/// Loads the charset from the file if it exists, or parses the argument itself.
+static bool loadCharset(std::vector<unicode_t> &charset, const char *arg) {
+    if (FILE *file = fopen(arg, "r")) {
+        std::string contents;
+        for (int c; (c = fgetc(file)) != EOF;)
+            contents.push_back(char(c));
+        fclose(file);
+        return parseCharset(charset, contents.c_str());
+    }
+    return parseCharset(charset, arg);
+}
+
+/// Returns true if the argument following arg is an output filename, which must contain a character code conversion in charset mode.
+static bool isOutputFilenameArg(const char *arg) {
+    if (arg[0] == '-' && arg[1] == '-')
+        ++arg;
+    return (
+        !strcmp(arg, "-o") || !strcmp(arg, "-out") || !strcmp(arg, "-output") || !strcmp(arg, "-imageout") ||
+        !strcmp(arg, "-testrender") || !strcmp(arg, "-testrendermulti") ||
+        !strcmp(arg, "-exportshape") || !strcmp(arg, "-exportbinshape") || !strcmp(arg, "-exportsvg")
+    );
+}
+
+/// Formats the filename pattern, which must contain exactly one conversion %d, %u, %x, or %X with an optional zero flag and width, for the character code.
+static bool formatCharsetFilename(std::string &filename, const char *pattern, unicode_t unicode) {
+    bool converted = false;
+    filename.clear();
+    for (; *pattern; ++pattern) {
+        if (*pattern != '%') {
+            filename.push_back(*pattern);
+            continue;
+        }
+        if (*++pattern == '%') {
+            filename.push_back('%');
+            continue;
+        }
+        char padding = ' ';
+        if (*pattern == '0')
+            padding = '0', ++pattern;
+        int width = 0;
+        while (*pattern >= '0' && *pattern <= '9' && width < 100)
+            width = 10*width+(*pattern++-'0');
+        const char *digits = NULL;
+        unsigned base = 16;
+        switch (*pattern) {
+            case 'd': case 'u':
+                base = 10;
+                // fallthrough
+            case 'x':
+                digits = "0123456789abcdef";
+                break;
+            case 'X':
+                digits = "0123456789ABCDEF";
+                break;
+        }
+        if (!digits || converted)
+            return false;
+        std::string number;
+        unsigned value = unicode;
+        do {
+            number.insert(number.begin(), digits[value%base]);
+            value /= base;
+        } while (value);
+        if (int(number.size()) < width)
+            filename.append(width-number.size(), padding);
+        filename += number;
+        converted = true;
+    }
+    return converted;
+}
+
+/// Runs the job for each character of the charset, with the character code at codeArgPos and output filenames formatted for it. Returns the program's exit code.
+static int runCharset(const char *charsetArg, const std::vector<const char *> &commonArgs, int codeArgPos) {
+    std::vector<unicode_t> charset;
+    if (!loadCharset(charset, charsetArg)) {
+        fputs("Invalid charset! Use a list of character codes and ranges separated by commas, e.g. 0x20-0x7e,0xa0.\n", stderr);
+        return 1;
+    }
+    std::sort(charset.begin(), charset.end());
+    charset.erase(std::unique(charset.begin(), charset.end()), charset.end());
+
+    bool outputSpecified = false, metricsMode = false;
+    std::string filename;
+    for (int i = 1; i < int(commonArgs.size()); ++i) {
+        if (!strcmp(commonArgs[i], "metrics"))
+            metricsMode = true;
+        if (i+1 < int(commonArgs.size()) && isOutputFilenameArg(commonArgs[i])) {
+            if (!formatCharsetFilename(filename, commonArgs[i+1], 0)) {
+                fputs("Output filenames must contain one character code conversion when using -charset, e.g. out/%04x.png\n", stderr);
+                return 1;
+            }
+            outputSpecified = true;
+        }
+    }
+    if (!(outputSpecified || metricsMode)) {
+        fputs("No output filename specified! Use -o with a character code conversion when using -charset, e.g. out/%04x.png\n", stderr);
+        return 1;
+    }
+
+    JobContext context;
+    int charsetSize = int(charset.size());
+    int failedJobs = 0;
+#ifdef MSDFGEN_USE_OPENMP
+    #pragma omp parallel reduction(+:failedJobs)
+#endif
+    {
+        // Printed text is buffered so that it can be output in charset order
+        TextBuffer textBuffer;
+        std::string text;
+        std::vector<std::string> filenames(commonArgs.size());
+        char code[16];
+#ifdef MSDFGEN_USE_OPENMP
+        #pragma omp for schedule(dynamic) ordered
+#endif
+        for (int i = 0; i < charsetSize; ++i) {
+            std::vector<const char *> argv(commonArgs);
+            for (int j = 1; j+1 < int(argv.size()); ++j) {
+                if (isOutputFilenameArg(argv[j])) {
+                    formatCharsetFilename(filenames[j+1], argv[j+1], charset[i]);
+                    argv[j+1] = filenames[j+1].c_str();
+                }
+            }
+            sprintf(code, "0x%X", (unsigned) charset[i]);
+            argv[codeArgPos] = code;
+            FILE *textOutput = textBuffer.begin();
+            bool success = !runJob(int(argv.size()), &argv[0], context, textOutput ? textOutput : stdout);
+            textBuffer.end(text);
+#ifdef MSDFGEN_USE_OPENMP
+            #pragma omp ordered
+#endif
+            {
+                if (!text.empty()) {
+                    printf("unicode = 0x%04X\n", (unsigned) charset[i]);
+                    fwrite(text.data(), 1, text.size(), stdout);
+                }
+                if (!success) {
+                    fprintf(stderr, "Job for character 0x%04X failed.\n", (unsigned) charset[i]);
+                    ++failedJobs;
+                }
+            }
+        }
+    }
+    return failedJobs ? 1 : 0;
+}
+
+static bool writeAtlasLayout(const char *filename, const char *type, int width, int height, double scale, Range pxRange, const std::vector<unicode_t> &charset, const std::vector<double> &advances, const std::vector<AtlasRegion> &regions) {
+    FILE *file = fopen(filename, "w");
+    if (!file)
+        return false;
+    fprintf(file, "{\"atlas\":{\"type\":\"%s\",\"distanceRange\":%.17g,\"emSize\":%.17g,\"width\":%d,\"height\":%d,\"yOrigin\":\"%s\"},\"glyphs\":[", type, pxRange.upper-pxRange.lower, scale, width, height, MSDFGEN_Y_AXIS_DEFAULT_ORIENTATION == Y_UPWARD ? "bottom" : "top");
+    for (size_t i = 0; i < charset.size(); ++i) {
+        const AtlasRegion &region = regions[i];
+        fprintf(file, "%s\n{\"unicode\":%u,\"advance\":%.17g", i ? "," : "", (unsigned) charset[i], advances[i]);
+        if (region.width > 0 && region.height > 0) {
+            fprintf(file, ",\"planeBounds\":{\"left\":%.17g,\"bottom\":%.17g,\"right\":%.17g,\"top\":%.17g}", -region.translate.x, -region.translate.y, region.width/scale-region.translate.x, region.height/scale-region.translate.y);
+            fprintf(file, ",\"atlasBounds\":{\"left\":%d,\"bottom\":%d,\"right\":%d,\"top\":%d}", region.x, region.y, region.x+region.width, region.y+region.height);
+        }
+        fputc('}', file);
+    }
+    fputs("\n]}\n", file);
+    return !fclose(file);
+}
+
+/// Generates the glyphs of the charset, whose character codes would be at codeArgPos, into a single atlas, and writes its layout into a JSON file. Returns the program's exit code.
+/// Each glyph is generated by a job with the remaining arguments, framed to its region of the atlas, so that it is identical to a single glyph generated with the same options.
+static int runAtlas(const char *charsetArg, const std::vector<const char *> &args, int codeArgPos) {
+    const char *fontFilename = NULL;
+    bool variableFont = false;
+    const char *layoutFilename = NULL;
+    const char *output = "output." DEFAULT_IMAGE_EXTENSION;
+    bool outputSpecified = false;
+    Format format = AUTO;
+    const char *type = "msdf";
+    int channels = 3;
+    double scale = 32;
+    // Range in pixels, or in ems if unitRange is set, which determines the padding of the regions
+    Range range(2);
+    bool unitRange = false;
+    unsigned spacing = 0;
+    std::vector<const char *> jobArgs(1, args[0]);
+    int jobCodeArgPos = 0;
+    for (int argPos = 1; argPos < int(args.size()); ++argPos) {
+        if (argPos == codeArgPos) {
+            jobCodeArgPos = int(jobArgs.size());
+            jobArgs.push_back(NULL);
+            continue;
+        }
+        const char *arg = args[argPos];
+        const char *param = argPos+1 < int(args.size()) ? args[argPos+1] : NULL;
+        const char *param2 = argPos+2 < int(args.size()) ? args[argPos+2] : NULL;
+        double value, value2;
+        if (arg[0] == '-' && arg[1] == '-')
+            ++arg;
+        // Arguments of the atlas itself
+        if (param && !strcmp(arg, "-atlas")) {
+            layoutFilename = args[++argPos];
+            continue;
+        }
+        if (param && (!strcmp(arg, "-o") || !strcmp(arg, "-out") || !strcmp(arg, "-output") || !strcmp(arg, "-imageout"))) {
+            output = args[++argPos];
+            outputSpecified = true;
+            continue;
+        }
+        if (param && !strcmp(arg, "-format")) {
+            const char *defaultOutput = NULL;
+            if (!parseFormat(format, defaultOutput, param))
+                ABORT("Unknown format specified.");
+            if (defaultOutput && !outputSpecified)
+                output = defaultOutput;
+            ++argPos;
+            continue;
+        }
+        if (param && !strcmp(arg, "-spacing")) {
+            if (!parseUnsigned(spacing, param))
+                ABORT("Invalid spacing. Use -spacing <pixels> with a non-negative integer.");
+            ++argPos;
+            continue;
+        }
+        if (param && !strcmp(arg, "-scale")) {
+            if (!(parseDouble(scale, param) && scale > 0))
+                ABORT("Invalid scale argument. Use -scale <scale> with a positive real number of pixels per em.");
+            ++argPos;
+            continue;
+        }
+        // Frame of each glyph is determined by the atlas
+        if (
+            !strcmp(arg, "metrics") || !strcmp(arg, "-autoframe") || !strcmp(arg, "-dimensions") || !strcmp(arg, "-size") || !strcmp(arg, "-translate") ||
+            !strcmp(arg, "-ascale") || !strcmp(arg, "-mips") || !strcmp(arg, "-stdout") || !strcmp(arg, "-exportshape") || !strcmp(arg, "-exportbinshape") ||
+            !strcmp(arg, "-exportsvg") || !strcmp(arg, "-testrender") || !strcmp(arg, "-testrendermulti")
+        ) {
+            fprintf(stderr, "Unsupported argument in atlas mode: %s\n", args[argPos]);
+            return 1;
+        }
+        // Arguments of the jobs which the atlas also needs to know
+        if (!strcmp(arg, "sdf") || !strcmp(arg, "psdf"))
+            type = arg, channels = 1;
+        else if (!strcmp(arg, "msdf"))
+            type = arg, channels = 3;
+        else if (!strcmp(arg, "mtsdf"))
+            type = arg, channels = 4;
+        else if (param && (!strcmp(arg, "-font") || !strcmp(arg, "-varfont"))) {
+            variableFont = !strcmp(arg, "-varfont");
+            fontFilename = param;
+        } else if (param && !strcmp(arg, "-pxrange") && parseDouble(value, param))
+            range = Range(value), unitRange = false;
+        else if (param && (!strcmp(arg, "-range") || !strcmp(arg, "-unitrange")) && parseDouble(value, param))
+            range = Range(value), unitRange = true;
+        else if (param2 && !strcmp(arg, "-apxrange") && parseDouble(value, param) && parseDouble(value2, param2))
+            range = Range(value, value2), unitRange = false;
+        else if (param2 && (!strcmp(arg, "-arange") || !strcmp(arg, "-aunitrange")) && parseDouble(value, param) && parseDouble(value2, param2))
+            range = Range(value, value2), unitRange = true;
+        jobArgs.push_back(args[argPos]);
+    }
+    if (!fontFilename)
+        ABORT("No font specified! Use -font <file.ttf/otf> -charset <charset> -atlas <layout.json>.");
+    if (!layoutFilename)
+        ABORT("No layout output file specified.");
+    Range pxRange = unitRange ? scale*range : range;
+
+    std::vector<unicode_t> charset;
+    if (!loadCharset(charset, charsetArg) || charset.empty())
+        ABORT("Invalid charset! Use a list of character codes and ranges separated by commas, e.g. 0x20-0x7e,0xa0.");
+    std::sort(charset.begin(), charset.end());
+    charset.erase(std::unique(charset.begin(), charset.end()), charset.end());
+
+    // Glyphs are loaded in coordinates normalized to 1 em to lay out the atlas, and retained for the jobs, which load them the same way
+    JobContext context;
+    context.fontCache.retainGlyphs();
+    int glyphCount = int(charset.size());
+    std::vector<Shape> shapes(glyphCount);
+    std::vector<double> advances(glyphCount);
+    for (int i = 0; i < glyphCount; ++i) {
+        Shape &shape = shapes[i];
+        if (const char *error = context.fontCache.getGlyph(shape, &advances[i], fontFilename, variableFont, GlyphIndex(), charset[i], FONT_SCALING_EM_NORMALIZED)) {
+            fprintf(stderr, "%s\n", error);
+            return 1;
+        }
+        shape.normalize();
+    }
+
+    std::vector<AtlasRegion> regions(glyphCount);
+    int width = 0, height = 0;
+    packAtlas(&regions[0], width, height, &shapes[0], glyphCount, scale, pxRange, int(spacing));
+    width = max(width, 1), height = max(height, 1);
+
+    // Pixels between regions are set to the outermost distance
+    std::vector<float> atlas(channels*size_t(width)*size_t(height), 0.f);
+    char scaleArg[32];
+    sprintf(scaleArg, "%.17g", scale);
+    int failedJobs = 0;
+#ifdef MSDFGEN_USE_OPENMP
+    #pragma omp parallel reduction(+:failedJobs)
+#endif
+    {
+        // Printed text is buffered so that it can be output in charset order
+        TextBuffer textBuffer;
+        std::string text;
+        char code[16], translateX[32], translateY[32], widthArg[16], heightArg[16];
+#ifdef MSDFGEN_USE_OPENMP
+        #pragma omp for schedule(dynamic) ordered
+#endif
+        for (int i = 0; i < glyphCount; ++i) {
+            const AtlasRegion &region = regions[i];
+            bool success = true;
+            text.clear();
+            if (region.width > 0 && region.height > 0) {
+                std::vector<const char *> argv(jobArgs);
+                sprintf(code, "0x%X", (unsigned) charset[i]);
+                sprintf(translateX, "%.17g", region.translate.x);
+                sprintf(translateY, "%.17g", region.translate.y);
+                sprintf(widthArg, "%d", region.width);
+                sprintf(heightArg, "%d", region.height);
+                argv[jobCodeArgPos] = code;
+                const char *frameArgs[] = { "-emnormalize", "-scale", scaleArg, "-translate", translateX, translateY, "-dimensions", widthArg, heightArg };
+                argv.insert(argv.end(), frameArgs, frameArgs+sizeof(frameArgs)/sizeof(*frameArgs));
+                // The job generates its distance field directly into its region of the atlas
+                JobOutput cell;
+                cell.width = region.width, cell.height = region.height, cell.channels = channels;
+                cell.target = &atlas[channels*(size_t(width)*region.y+region.x)];
+                cell.targetRowStride = channels*width;
+                FILE *textOutput = textBuffer.begin();
+                success = !runJob(int(argv.size()), &argv[0], context, textOutput ? textOutput : stdout, &cell) && cell.target;
+                textBuffer.end(text);
+            }
+#ifdef MSDFGEN_USE_OPENMP
+            #pragma omp ordered
+#endif
+            {
+                if (!text.empty()) {
+                    printf("unicode = 0x%04X\n", (unsigned) charset[i]);
+                    fwrite(text.data(), 1, text.size(), stdout);
+                }
+                if (!success) {
+                    fprintf(stderr, "Job for character 0x%04X failed.\n", (unsigned) charset[i]);
+                    ++failedJobs;
+                }
+            }
+        }
+    }
+    if (failedJobs)
+        return 1;
+
+    const char *error = NULL;
+    switch (channels) {
+        case 1:
+            error = writeOutput<1>(BitmapConstSection<float, 1>(&atlas[0], width, height), output, format);
+            break;
+        case 3:
+            error = writeOutput<3>(BitmapConstSection<float, 3>(&atlas[0], width, height), output, format);
+            break;
+        case 4:
+            error = writeOutput<4>(BitmapConstSection<float, 4>(&atlas[0], width, height), output, format);
+            break;
+    }
+    if (error) {
+        fprintf(stderr, "%s\n", error);
+        return 1;
+    }
+    if (!writeAtlasLayout(layoutFilename, type, width, height, scale, pxRange, charset, advances, regions))
+        ABORT("Failed to write atlas layout file.");
+    return 0;
+}
+
+#endif
+
+int main(int argc, const char *const *argv) {
+    for (int argPos = 1; argPos < argc; ++argPos) {
+        const char *arg = argv[argPos];
+        if (arg[0] == '-' && arg[1] == '-')
+            ++arg;
+        if (!strcmp(arg, "-batch") && argPos+1 < argc) {
+            std::vector<const char *> commonArgs(argv, argv+argPos);
+            commonArgs.insert(commonArgs.end(), argv+argPos+2, argv+argc);
+            return runBatch(argv[argPos+1], commonArgs);
+        }
+    #ifdef MSDFGEN_EXTENSIONS
+        if (!strcmp(arg, "-charset") && argPos+1 < argc) {
+            // The character code takes the place of the charset argument
+            std::vector<const char *> commonArgs(argv, argv+argPos+1);
+            commonArgs.insert(commonArgs.end(), argv+argPos+2, argv+argc);
+            for (std::vector<const char *>::const_iterator commonArg = commonArgs.begin(); commonArg != commonArgs.end(); ++commonArg) {
+                if (!strcmp(*commonArg, "-atlas") || !strcmp(*commonArg, "--atlas"))
+                    return runAtlas(argv[argPos+1], commonArgs, argPos);
+            }
+            return runCharset(argv[argPos+1], commonArgs, argPos);
+        }
+    #endif
+        if (!strcmp(arg, "-server")) {
+            std::vector<const char *> commonArgs(argv, argv+argPos);
+            commonArgs.insert(commonArgs.end(), argv+argPos+1, argv+argc);
+            return runServer(commonArgs);
+        }
+    }
+    JobContext context;
+    return runJob(argc, argv, context);
+}
+
 #endif
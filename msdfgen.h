@@ -29,16 +29,22 @@
 #include "core/bitmap-interpolation.hpp"
 #include "core/pixel-conversion.hpp"
 #include "core/edge-coloring.h"
+#include "core/resolve-overlaps.h"
+#include "core/viewport-culling.h"
+#include "core/shape-flattening.h"
 #include "core/generator-config.h"
 #include "core/msdf-error-correction.h"
+#include "core/atlas.h"
 #include "core/render-sdf.h"
 #include "core/rasterization.h"
+#include "core/distance-transform.h"
 #include "core/sdf-error-estimation.h"
 #include "core/save-bmp.h"
 #include "core/save-tiff.h"
 #include "core/save-rgba.h"
 #include "core/save-fl32.h"
 #include "core/shape-description.h"
+#include "core/shape-binary.h"
 #include "core/export-svg.h"
 
 namespace msdfgen {
@@ -55,6 +61,30 @@ void generateMSDF(const BitmapSection<float, 3> &output, const Shape &shape, con
 /// Generates a multi-channel signed distance field with true distance in the alpha channel. Edge colors must be assigned first.
 void generateMTSDF(const BitmapSection<float, 4> &output, const Shape &shape, const SDFTransformation &transformation, const MSDFGeneratorConfig &config = MSDFGeneratorConfig());
 
+/// Generates a signed distance field in the first channel and the unit gradient of the distance in shape coordinates, mapped from [-1, 1] to [0, 1], in the other two.
+/// The gradient is computed analytically from the nearest edge, and the offset of the nearest point on the shape is the negative distance times the gradient.
+void generateSDFWithGradient(const BitmapSection<float, 3> &output, const Shape &shape, const SDFTransformation &transformation, const GeneratorConfig &config = GeneratorConfig());
+
+/// Generates distance fields of the same shape at multiple levels of detail, such as a mipmap chain, each with its own transformation.
+/// Preprocessing of the shape and distance finders are shared between the levels, and each level is identical to its separate generation.
+void generateSDFLevels(const BitmapSection<float, 1> *outputs, const Shape &shape, const SDFTransformation *transformations, int levelCount, const GeneratorConfig &config = GeneratorConfig());
+void generatePSDFLevels(const BitmapSection<float, 1> *outputs, const Shape &shape, const SDFTransformation *transformations, int levelCount, const GeneratorConfig &config = GeneratorConfig());
+void generateMSDFLevels(const BitmapSection<float, 3> *outputs, const Shape &shape, const SDFTransformation *transformations, int levelCount, const MSDFGeneratorConfig &config = MSDFGeneratorConfig());
+void generateMTSDFLevels(const BitmapSection<float, 4> *outputs, const Shape &shape, const SDFTransformation *transformations, int levelCount, const MSDFGeneratorConfig &config = MSDFGeneratorConfig());
+
+/// Generates a distance field by evaluating distance exactly only on a coarse grid, in its cells where bilinear interpolation appears to deviate from the exact field by more than threshold (in pixels),
+/// and near the edges. The deviation is judged heuristically, so threshold does not bound the actual error. Returns the number of exact distance evaluations saved compared to the regular generator.
+int generateSDFAdaptive(const BitmapSection<float, 1> &output, const Shape &shape, const SDFTransformation &transformation, double threshold, const GeneratorConfig &config = GeneratorConfig());
+int generatePSDFAdaptive(const BitmapSection<float, 1> &output, const Shape &shape, const SDFTransformation &transformation, double threshold, const GeneratorConfig &config = GeneratorConfig());
+int generateMSDFAdaptive(const BitmapSection<float, 3> &output, const Shape &shape, const SDFTransformation &transformation, double threshold, const MSDFGeneratorConfig &config = MSDFGeneratorConfig());
+int generateMTSDFAdaptive(const BitmapSection<float, 4> &output, const Shape &shape, const SDFTransformation &transformation, double threshold, const MSDFGeneratorConfig &config = MSDFGeneratorConfig());
+
+/// Generates a distance field whose values are exact only within bandWidth pixels of the shape's edges. Elsewhere, all channels hold the true distance
+/// to the nearest edge of a nearby texel of the band, which is found by sweeping over the bitmap in four directions and is the nearest edge at least approximately.
+/// In an MTSDF, this includes the color channels, which therefore only hold multi-channel distance within the band. It should cover the distance range wherever it isn't clamped.
+void generateSDFNarrowBand(const BitmapSection<float, 1> &output, const Shape &shape, const SDFTransformation &transformation, double bandWidth, const GeneratorConfig &config = GeneratorConfig());
+void generateMTSDFNarrowBand(const BitmapSection<float, 4> &output, const Shape &shape, const SDFTransformation &transformation, double bandWidth, const MSDFGeneratorConfig &config = MSDFGeneratorConfig());
+
 // Old version of the function API's kept for backwards compatibility
 void generateSDF(const BitmapSection<float, 1> &output, const Shape &shape, const Projection &projection, Range range, const GeneratorConfig &config = GeneratorConfig());
 void generatePSDF(const BitmapSection<float, 1> &output, const Shape &shape, const Projection &projection, Range range, const GeneratorConfig &config = GeneratorConfig());